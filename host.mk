@@ -0,0 +1,33 @@
+################################################################################
+######################## Host build of the command library #####################
+# Builds the command library with the host compiler against the PROS stand-in in
+# host/include, so the scheduler can be run and profiled natively.
+#
+#   make host      build every program in host/src into bin/host
+#   make host-run  build and run the simulation
+#   make host-bench build and run the scheduler benchmarks
+#   make host-test build and run the host tests
+HOSTCXX?=g++
+HOSTDIR=$(ROOT)/host
+HOSTBINDIR=$(BINDIR)/host
+HOSTCXXFLAGS?=-std=gnu++20 -O2 -g -Wall -Wextra -Wno-unused-parameter -pthread
+HOSTINCLUDE=-iquote"$(HOSTDIR)/include" -iquote"$(INCDIR)"
+HOSTHEADERS=$(wildcard $(HOSTDIR)/include/*.h) $(wildcard $(INCDIR)/command/*.h)
+HOSTPROGRAMS=$(patsubst $(HOSTDIR)/src/%.cpp,$(HOSTBINDIR)/%,$(wildcard $(HOSTDIR)/src/*.cpp))
+
+.PHONY: host host-run host-bench host-test
+
+host: $(HOSTPROGRAMS)
+
+host-run: $(HOSTBINDIR)/simulation
+	$(HOSTBINDIR)/simulation
+
+host-bench: $(HOSTBINDIR)/benchmark
+	$(HOSTBINDIR)/benchmark
+
+host-test: $(HOSTBINDIR)/tests
+	$(HOSTBINDIR)/tests
+
+$(HOSTBINDIR)/%: $(HOSTDIR)/src/%.cpp $(HOSTHEADERS)
+	$(VV)mkdir -p $(HOSTBINDIR)
+	$(call test_output_2,Compiled $< for host ,$(HOSTCXX) $(HOSTCXXFLAGS) $(HOSTINCLUDE) -o $@ $<,$(OK_STRING))
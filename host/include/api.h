@@ -0,0 +1,324 @@
+/**
+ * \file api.h
+ *
+ * Host stand-in for the parts of the PROS API used by the command library. The library headers include "api.h", and
+ * the host build puts this directory ahead of include/ on the quote include path so this file is used instead of the
+ * real PROS headers.
+ *
+ * The stand-in runs on a virtual clock that only moves when pros::delay, pros::c::task_delay_until or
+ * pros::host::advance are called, so simulations run as fast as the host can execute them. Competition state and
+ * controller inputs are set or scripted through the pros::host namespace.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#define TASK_PRIORITY_DEFAULT 8
+#define TASK_STACK_DEPTH_DEFAULT 0x2000
+#define TIMEOUT_MAX ((std::uint32_t) 0xffffffffUL)
+
+namespace pros {
+	typedef enum { E_CONTROLLER_MASTER = 0, E_CONTROLLER_PARTNER } controller_id_e_t;
+
+	typedef enum {
+		E_CONTROLLER_ANALOG_LEFT_X = 0,
+		E_CONTROLLER_ANALOG_LEFT_Y,
+		E_CONTROLLER_ANALOG_RIGHT_X,
+		E_CONTROLLER_ANALOG_RIGHT_Y
+	} controller_analog_e_t;
+
+	typedef enum {
+		E_CONTROLLER_DIGITAL_L1 = 6,
+		E_CONTROLLER_DIGITAL_L2,
+		E_CONTROLLER_DIGITAL_R1,
+		E_CONTROLLER_DIGITAL_R2,
+		E_CONTROLLER_DIGITAL_UP,
+		E_CONTROLLER_DIGITAL_DOWN,
+		E_CONTROLLER_DIGITAL_LEFT,
+		E_CONTROLLER_DIGITAL_RIGHT,
+		E_CONTROLLER_DIGITAL_X,
+		E_CONTROLLER_DIGITAL_B,
+		E_CONTROLLER_DIGITAL_Y,
+		E_CONTROLLER_DIGITAL_A
+	} controller_digital_e_t;
+
+	/**
+	 * Controls for the simulated robot, these don't exist in the real PROS API
+	 */
+	namespace host {
+		enum class Mode { Disabled, Autonomous, Opcontrol };
+
+		struct ControllerState {
+			std::array<std::int32_t, 4> analog{};
+			std::array<bool, 12> digital{};
+		};
+
+		struct ScriptedInput {
+			std::uint32_t time;
+			controller_id_e_t controller;
+			controller_digital_e_t button;
+			bool pressed;
+		};
+
+		struct State {
+			std::uint64_t micros = 0;
+			Mode mode = Mode::Opcontrol;
+			bool connected = false;
+			std::array<ControllerState, 2> controllers{};
+			std::vector<ScriptedInput> script;
+			std::uint32_t calls = 0;
+		};
+
+		inline State &state() {
+			static State state;
+			return state;
+		}
+
+		/**
+		 * Number of calls made into the stand-in since the last reset, a proxy for firmware call overhead
+		 */
+		inline std::uint32_t getCalls() { return state().calls; }
+
+		// Commands can run on worker tasks, so the call counter is the one piece of state updated from several threads.
+		// A relaxed load and store avoids a locked add on every call, concurrent calls may only be counted once
+		inline void countCall() {
+			std::atomic_ref calls(state().calls);
+			calls.store(calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Reset the clock, competition state, controllers and script
+		 */
+		inline void reset() { state() = State{}; }
+
+		inline void setMode(const Mode mode) { state().mode = mode; }
+
+		inline void setConnected(const bool connected) { state().connected = connected; }
+
+		inline void setDigital(const controller_id_e_t controller, const controller_digital_e_t button,
+		                       const bool pressed) {
+			state().controllers[controller].digital[button - E_CONTROLLER_DIGITAL_L1] = pressed;
+		}
+
+		inline void setAnalog(const controller_id_e_t controller, const controller_analog_e_t axis,
+		                      const std::int32_t value) {
+			state().controllers[controller].analog[axis] = value;
+		}
+
+		/**
+		 * Schedule a button change, applied once the virtual clock reaches time
+		 *
+		 * @param time Virtual time in milliseconds
+		 */
+		inline void script(const std::uint32_t time, const controller_id_e_t controller,
+		                   const controller_digital_e_t button, const bool pressed) {
+			auto &script = state().script;
+
+			script.push_back({time, controller, button, pressed});
+			std::stable_sort(script.begin(), script.end(),
+			                 [](const ScriptedInput &a, const ScriptedInput &b) { return a.time < b.time; });
+		}
+
+		/**
+		 * Move the virtual clock forward, applying any scripted inputs that are now due
+		 */
+		inline void advanceMicros(const std::uint64_t micros) {
+			State &current = state();
+
+			current.micros += micros;
+
+			const auto due = std::find_if(current.script.begin(), current.script.end(), [&current](auto &input) {
+				return input.time * 1000ull > current.micros;
+			});
+
+			for (auto input = current.script.begin(); input != due; ++input) {
+				setDigital(input->controller, input->button, input->pressed);
+			}
+
+			current.script.erase(current.script.begin(), due);
+		}
+
+		inline void advance(const std::uint32_t milliseconds) { advanceMicros(milliseconds * 1000ull); }
+
+		/**
+		 * Microseconds of host wall time, for profiling code that runs on the virtual clock
+		 */
+		inline std::uint64_t wallMicros() {
+			return std::chrono::duration_cast<std::chrono::microseconds>(
+			               std::chrono::steady_clock::now().time_since_epoch())
+			        .count();
+		}
+	} // namespace host
+
+	inline std::uint32_t millis() {
+		host::countCall();
+		return static_cast<std::uint32_t>(host::state().micros / 1000);
+	}
+
+	inline std::uint64_t micros() {
+		host::countCall();
+		return host::state().micros;
+	}
+
+	inline void delay(const std::uint32_t milliseconds) { host::advance(milliseconds); }
+
+	typedef void *task_t;
+
+	namespace host {
+		/**
+		 * Notification value of a task, what pros::c::task_notify and pros::c::task_notify_take operate on
+		 */
+		struct TaskState {
+			std::mutex mutex;
+			std::condition_variable condition;
+			std::uint32_t notifications = 0;
+		};
+
+		// The task of the calling thread, created on first use for threads that weren't started by pros::Task
+		inline TaskState *&currentTask() {
+			thread_local TaskState *task = nullptr;
+			return task;
+		}
+	} // namespace host
+
+	/**
+	 * Tasks run on detached host threads, priorities and stack depths are ignored. The virtual clock and inputs aren't
+	 * synchronized, so simulations should only move them while no task is using them
+	 */
+	class Task {
+	public:
+		template<class F>
+		static task_t create(F &&function, std::uint32_t prio = TASK_PRIORITY_DEFAULT,
+		                     std::uint16_t stack_depth = TASK_STACK_DEPTH_DEFAULT, const char *name = "") {
+			auto *task = new host::TaskState();
+
+			std::thread([task, function = std::forward<F>(function)]() mutable {
+				host::currentTask() = task;
+				function();
+			}).detach();
+
+			return task;
+		}
+	};
+
+	namespace c {
+		inline task_t task_get_current() {
+			host::TaskState *&task = host::currentTask();
+
+			if (task == nullptr) {
+				task = new host::TaskState();
+			}
+
+			return task;
+		}
+
+		inline std::uint32_t task_notify(const task_t task) {
+			auto *state = static_cast<host::TaskState *>(task);
+
+			{
+				std::lock_guard lock(state->mutex);
+				state->notifications++;
+			}
+
+			state->condition.notify_one();
+
+			return 1;
+		}
+
+		inline std::uint32_t task_notify_take(const bool clear_on_exit, const std::uint32_t timeout) {
+			auto *state = static_cast<host::TaskState *>(task_get_current());
+			std::unique_lock lock(state->mutex);
+
+			const auto notified = [state]() { return state->notifications > 0; };
+
+			if (timeout == TIMEOUT_MAX) {
+				state->condition.wait(lock, notified);
+			} else {
+				state->condition.wait_for(lock, std::chrono::milliseconds(timeout), notified);
+			}
+
+			const std::uint32_t value = state->notifications;
+
+			if (value > 0) {
+				state->notifications = clear_on_exit ? 0 : value - 1;
+			}
+
+			return value;
+		}
+
+		inline void task_delay_until(std::uint32_t *const prev_time, const std::uint32_t delta) {
+			const std::uint32_t wake = *prev_time + delta;
+			const std::uint32_t now = millis();
+
+			if (wake > now) {
+				host::advance(wake - now);
+			}
+
+			*prev_time = wake;
+		}
+	} // namespace c
+
+	namespace competition {
+		inline std::uint8_t is_disabled() {
+			host::countCall();
+			return host::state().mode == host::Mode::Disabled;
+		}
+
+		inline std::uint8_t is_autonomous() {
+			host::countCall();
+			return host::state().mode == host::Mode::Autonomous;
+		}
+
+		inline std::uint8_t is_connected() {
+			host::countCall();
+			return host::state().connected;
+		}
+	} // namespace competition
+
+	class Controller {
+	private:
+		controller_id_e_t id;
+
+	public:
+		explicit Controller(const controller_id_e_t id) : id(id) {}
+
+		std::int32_t get_digital(const controller_digital_e_t button) {
+			host::countCall();
+			return host::state().controllers[id].digital[button - E_CONTROLLER_DIGITAL_L1];
+		}
+
+		std::int32_t get_analog(const controller_analog_e_t axis) {
+			host::countCall();
+			return host::state().controllers[id].analog[axis];
+		}
+	};
+} // namespace pros
+
+#define CONTROLLER_MASTER pros::E_CONTROLLER_MASTER
+#define CONTROLLER_PARTNER pros::E_CONTROLLER_PARTNER
+#define ANALOG_LEFT_X pros::E_CONTROLLER_ANALOG_LEFT_X
+#define ANALOG_LEFT_Y pros::E_CONTROLLER_ANALOG_LEFT_Y
+#define ANALOG_RIGHT_X pros::E_CONTROLLER_ANALOG_RIGHT_X
+#define ANALOG_RIGHT_Y pros::E_CONTROLLER_ANALOG_RIGHT_Y
+#define DIGITAL_L1 pros::E_CONTROLLER_DIGITAL_L1
+#define DIGITAL_L2 pros::E_CONTROLLER_DIGITAL_L2
+#define DIGITAL_R1 pros::E_CONTROLLER_DIGITAL_R1
+#define DIGITAL_R2 pros::E_CONTROLLER_DIGITAL_R2
+#define DIGITAL_UP pros::E_CONTROLLER_DIGITAL_UP
+#define DIGITAL_DOWN pros::E_CONTROLLER_DIGITAL_DOWN
+#define DIGITAL_LEFT pros::E_CONTROLLER_DIGITAL_LEFT
+#define DIGITAL_RIGHT pros::E_CONTROLLER_DIGITAL_RIGHT
+#define DIGITAL_X pros::E_CONTROLLER_DIGITAL_X
+#define DIGITAL_B pros::E_CONTROLLER_DIGITAL_B
+#define DIGITAL_Y pros::E_CONTROLLER_DIGITAL_Y
+#define DIGITAL_A pros::E_CONTROLLER_DIGITAL_A
@@ -0,0 +1,432 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <thread>
+#include "api.h"
+#include "command/includes.h"
+
+// The replacement operator new below is paired with these deletes, GCC can't see that across the inlining
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+// Counts heap allocations while armed, to check that steady-state ticks don't allocate
+static bool countAllocations = false;
+static std::size_t allocations = 0;
+
+void *operator new(const std::size_t size) {
+	if (countAllocations) {
+		allocations++;
+	}
+
+	if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+		return pointer;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+
+using Clock = std::chrono::steady_clock;
+
+class BenchSubsystem : public Subsystem {
+public:
+	int periodicRuns = 0;
+
+	void periodic() override { periodicRuns++; }
+};
+
+// Command with a runtime list of requirements
+class RequiringCommand : public Command {
+private:
+	std::vector<Subsystem *> requirements;
+
+public:
+	explicit RequiringCommand(std::vector<Subsystem *> requirements) : requirements(std::move(requirements)) {}
+
+	std::vector<Subsystem *> getRequirements() override { return requirements; }
+};
+
+// Command doing a fixed amount of arithmetic each tick, standing in for vision or simulation work
+class BusyCommand : public Command {
+private:
+	std::uint32_t iterations;
+	volatile std::uint32_t sink = 0;
+
+public:
+	explicit BusyCommand(const std::uint32_t iterations) : iterations(iterations) {}
+
+	void execute() override {
+		std::uint32_t value = sink;
+
+		for (std::uint32_t i = 0; i < iterations; i++) {
+			value = value * 1664525u + 1013904223u;
+		}
+
+		sink = value;
+	}
+};
+
+struct Result {
+	double nanoseconds;
+	// Total allocations over all timed iterations
+	std::size_t allocations;
+};
+
+/**
+ * Times operation, repeating it until enough wall time has passed for a stable average
+ */
+template<typename F>
+Result measure(F &&operation) {
+	constexpr int WARMUP = 200;
+	constexpr auto MINIMUM_TIME = std::chrono::milliseconds(20);
+
+	for (int i = 0; i < WARMUP; i++) {
+		operation();
+	}
+
+	std::size_t iterations = 0;
+	allocations = 0;
+	countAllocations = true;
+
+	const auto start = Clock::now();
+	auto now = start;
+
+	do {
+		for (int i = 0; i < 100; i++) {
+			operation();
+		}
+		iterations += 100;
+		now = Clock::now();
+	} while (now - start < MINIMUM_TIME);
+
+	countAllocations = false;
+
+	const double nanoseconds = std::chrono::duration<double, std::nano>(now - start).count() / iterations;
+
+	return {nanoseconds, allocations};
+}
+
+Result measureTick() {
+	return measure([]() {
+		CommandScheduler::run();
+		pros::host::advance(10);
+	});
+}
+
+void report(const char *parameter, const std::size_t value, const Result &result) {
+	std::printf("  %-12s %4zu  %10.1f ns  %zu allocs\n", parameter, value, result.nanoseconds, result.allocations);
+}
+
+void setUp() {
+	CommandScheduler::reset();
+	pros::host::reset();
+}
+
+// Each subsystem has a default command, so every tick runs N periodics and N commands
+void benchmarkSubsystems(std::size_t &steadyStateAllocations) {
+	std::puts("Tick cost vs registered subsystems:");
+
+	for (std::size_t count = 1; count <= 64; count *= 2) {
+		setUp();
+
+		std::vector<std::unique_ptr<BenchSubsystem>> subsystems;
+		for (std::size_t i = 0; i < count; i++) {
+			auto &subsystem = subsystems.emplace_back(std::make_unique<BenchSubsystem>());
+			CommandScheduler::registerSubsystem(subsystem.get(), new RunCommand([]() {}, {subsystem.get()}));
+		}
+
+		const Result result = measureTick();
+		steadyStateAllocations += result.allocations;
+		report("subsystems", count, result);
+
+		// Unregister the subsystems before they are freed
+		CommandScheduler::reset();
+	}
+}
+
+void benchmarkCommands(std::size_t &steadyStateAllocations) {
+	std::puts("Tick cost vs scheduled commands:");
+
+	for (std::size_t count = 1; count <= 256; count *= 2) {
+		setUp();
+
+		int runs = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			(new RunCommand([&runs]() { runs++; }, {}))->schedule();
+		}
+
+		const Result result = measureTick();
+		steadyStateAllocations += result.allocations;
+		report("commands", count, result);
+	}
+}
+
+// Every binding watches a button that is never pressed, measuring the cost of polling the bindings
+void benchmarkTriggers(std::size_t &steadyStateAllocations) {
+	std::puts("Tick cost vs trigger bindings:");
+
+	for (std::size_t count = 1; count <= 512; count *= 2) {
+		setUp();
+
+		CommandController controller(pros::E_CONTROLLER_MASTER);
+		Command *command = new RunCommand([]() {}, {});
+
+		for (std::size_t i = 0; i < count; i++) {
+			controller.getTrigger(static_cast<pros::controller_digital_e_t>(DIGITAL_L1 + i % 12))->onTrue(command);
+		}
+
+		const Result result = measureTick();
+		steadyStateAllocations += result.allocations;
+		report("bindings", count, result);
+	}
+}
+
+// A single command nested inside depth Sequences, each level adding one layer of dispatch
+void benchmarkNesting(std::size_t &steadyStateAllocations) {
+	std::puts("Tick cost vs composite nesting depth:");
+
+	for (std::size_t depth = 1; depth <= 32; depth *= 2) {
+		setUp();
+
+		BenchSubsystem subsystem;
+		Command *command = new RunCommand([]() {}, {&subsystem});
+
+		for (std::size_t i = 0; i < depth; i++) {
+			command = new Sequence({command});
+		}
+
+		command->schedule();
+
+		const Result result = measureTick();
+		steadyStateAllocations += result.allocations;
+		report("depth", depth, result);
+	}
+}
+
+// A 50 step autonomous chain running its first step, nested with Sequence constructors and built by andThen, which
+// flattens it the first time it runs
+void benchmarkChain(std::size_t &steadyStateAllocations) {
+	constexpr std::size_t STEPS = 50;
+
+	std::puts("Tick cost of a 50 step andThen chain:");
+
+	for (const bool flattened : {false, true}) {
+		setUp();
+
+		BenchSubsystem subsystem;
+		Command *chain = new RunCommand([]() {}, {&subsystem});
+
+		for (std::size_t i = 1; i < STEPS; i++) {
+			Command *step = new RunCommand([]() {}, {&subsystem});
+
+			chain = flattened ? chain->andThen(step) : new Sequence({chain, step});
+		}
+
+		chain->schedule();
+
+		const Result result = measureTick();
+		steadyStateAllocations += result.allocations;
+		report(flattened ? "flattened" : "nested", STEPS, result);
+	}
+
+	// The same chain written as a coroutine awaiting each step
+	setUp();
+
+	BenchSubsystem subsystem;
+	std::vector<std::unique_ptr<RunCommand>> steps;
+
+	for (std::size_t i = 0; i < STEPS; i++) {
+		steps.emplace_back(std::make_unique<RunCommand>([]() {}, std::initializer_list<Subsystem *>{&subsystem}));
+	}
+
+	CoroutineCommand routine([&steps]() -> Routine {
+		for (const auto &step : steps) {
+			co_await step.get();
+		}
+	}, {&subsystem});
+
+	routine.schedule();
+
+	const Result result = measureTick();
+	steadyStateAllocations += result.allocations;
+	report("coroutine", STEPS, result);
+
+	routine.cancel();
+}
+
+// Commands with a timeout, raced against a WaitCommand like withTimeout used to build them, and with the timeout held
+// by the race
+void benchmarkTimeouts(std::size_t &steadyStateAllocations) {
+	constexpr std::size_t COMMANDS = 64;
+
+	std::puts("Tick cost of commands with a timeout:");
+
+	for (const bool fused : {false, true}) {
+		setUp();
+
+		for (std::size_t i = 0; i < COMMANDS; i++) {
+			Command *command = new RunCommand([]() {}, {});
+
+			if (fused) {
+				command->withTimeout(1000 * units::second)->schedule();
+			} else {
+				(new ParallelRaceGroup({command, new WaitCommand(1000 * units::second)}))->schedule();
+			}
+		}
+
+		const Result result = measureTick();
+		steadyStateAllocations += result.allocations;
+		report(fused ? "fused" : "raced", COMMANDS, result);
+	}
+}
+
+// Commands requiring the same subsystems, each schedule interrupts the previous command
+void benchmarkConflicts() {
+	std::puts("Schedule and cancel cost under conflict:");
+
+	for (std::size_t count = 1; count <= 8; count *= 2) {
+		setUp();
+
+		std::vector<std::unique_ptr<BenchSubsystem>> subsystems;
+		std::vector<Subsystem *> requirements;
+
+		for (std::size_t i = 0; i < count; i++) {
+			requirements.push_back(subsystems.emplace_back(std::make_unique<BenchSubsystem>()).get());
+		}
+
+		RequiringCommand first(requirements), second(requirements);
+		bool toggle = false;
+
+		report("interrupting", count, measure([&]() {
+			toggle = !toggle;
+			(toggle ? first : second).schedule();
+		}));
+
+		second.cancel();
+
+		report("sched+cancel", count, measure([&]() {
+			first.schedule();
+			first.cancel();
+		}));
+	}
+}
+
+// Independent heavy commands spread over a WorkerPool, reported against the serial run() with no pool
+void benchmarkParallel(std::size_t &steadyStateAllocations) {
+	constexpr std::size_t COMMANDS = 64;
+	constexpr std::uint32_t ITERATIONS = 20000;
+
+	const std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+
+	std::printf("Parallel tick cost vs worker tasks (%zu commands, %zu cores):\n", COMMANDS, cores);
+
+	std::vector<std::unique_ptr<BusyCommand>> commands;
+	for (std::size_t i = 0; i < COMMANDS; i++) {
+		commands.emplace_back(std::make_unique<BusyCommand>(ITERATIONS));
+	}
+
+	double serial = 0.0;
+
+	// Always try one worker so the pool is exercised on single core hosts
+	for (std::size_t workers = 0; workers == 0 || workers < std::max<std::size_t>(2, cores);
+	     workers = workers * 2 + 1) {
+		setUp();
+
+		std::unique_ptr<WorkerPool> pool;
+		if (workers > 0) {
+			pool = std::make_unique<WorkerPool>(workers);
+			CommandScheduler::setWorkerPool(pool.get());
+		}
+
+		for (const auto &command : commands) {
+			command->schedule();
+		}
+
+		const Result result = measureTick();
+		steadyStateAllocations += result.allocations;
+
+		if (workers == 0) {
+			serial = result.nanoseconds;
+		}
+
+		std::printf("  %-12s %4zu  %10.1f ns  %zu allocs  %.2fx\n", "workers", workers, result.nanoseconds,
+		            result.allocations, serial / result.nanoseconds);
+
+		CommandScheduler::reset();
+	}
+}
+
+// Builds the dejam binding from src/main.cpp, with the decorators on the heap and in a CommandArena
+void benchmarkArena() {
+	std::puts("Dejam command construction:");
+
+	setUp();
+
+	BenchSubsystem subsystem;
+
+	const auto build = [&subsystem]() {
+		return CommandArena::make<RunCommand>([]() {}, std::initializer_list<Subsystem *>{&subsystem})
+			->withTimeout(300 * units::millisecond)
+			->andThen(CommandArena::make<RunCommand>([]() {}, std::initializer_list<Subsystem *>{&subsystem})
+				->withTimeout(300 * units::millisecond))
+			->repeatedly();
+	};
+
+	// Allocations of one build, including the duplicate requirement checks of the groups that NDEBUG removes
+	const auto count = [](auto &&operation) {
+		allocations = 0;
+		countAllocations = true;
+		operation();
+		countAllocations = false;
+
+		return allocations;
+	};
+
+	// The heap version leaks like decorators without an arena do, so it is only built once
+	std::printf("  %-12s %zu allocs\n", "heap", count(build));
+
+	CommandArena arena;
+
+	const auto buildInArena = [&arena, &build]() {
+		{
+			CommandArena::Scope scope(arena);
+			build();
+		}
+
+		arena.reset();
+	};
+
+	buildInArena();
+	const std::size_t arenaAllocations = count(buildInArena);
+
+	std::printf("  %-12s %zu allocs, %.1f ns per build and reset\n", "arena", arenaAllocations,
+	            measure(buildInArena).nanoseconds);
+}
+
+/**
+ * Reports the cost of the scheduler as the robot grows. Exits with an error if a steady-state tick allocated
+ */
+int main() {
+	std::size_t steadyStateAllocations = 0;
+
+	benchmarkSubsystems(steadyStateAllocations);
+	benchmarkCommands(steadyStateAllocations);
+	benchmarkTriggers(steadyStateAllocations);
+	benchmarkNesting(steadyStateAllocations);
+	benchmarkChain(steadyStateAllocations);
+	benchmarkTimeouts(steadyStateAllocations);
+	benchmarkConflicts();
+	benchmarkParallel(steadyStateAllocations);
+	benchmarkArena();
+
+	if (steadyStateAllocations != 0) {
+		std::printf("Steady-state ticks made %zu heap allocations\n", steadyStateAllocations);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,99 @@
+// Profile against the wall clock, the virtual clock doesn't move while the scheduler runs
+#define COMMAND_PROFILING
+#define COMMAND_PROFILER_CLOCK pros::host::wallMicros
+
+#include <chrono>
+#include <cstdio>
+#include "api.h"
+#include "command/includes.h"
+
+using namespace units;
+
+/**
+ * Simulated intake, tracks the commanded power instead of driving a motor
+ */
+class SimulatedIntake : public Subsystem {
+private:
+	double pct = 0.0;
+
+public:
+	void periodic() override {}
+
+	void setPct(const double pct) { this->pct = pct; }
+
+	[[nodiscard]] double getPct() const { return pct; }
+
+	RunCommand *pctCommand(const double pct) {
+		return new RunCommand([this, pct]() { this->setPct(pct); }, {this});
+	}
+};
+
+/**
+ * Runs the bindings from src/main.cpp against scripted driver inputs on the virtual clock, as fast as the host allows
+ */
+int main() {
+	constexpr std::uint32_t SIMULATED_MILLISECONDS = 10 * 60 * 1000;
+
+	CommandController primary(pros::E_CONTROLLER_MASTER);
+	SimulatedIntake intake;
+
+	CommandScheduler::registerSubsystem(&intake, intake.pctCommand(0.0));
+
+	primary.getTrigger(DIGITAL_R1)->whileTrue(intake.pctCommand(-1.0));
+	primary.getTrigger(DIGITAL_R2)->toggleOnTrue(intake.pctCommand(1.0));
+	primary.getTrigger(DIGITAL_A)->whileTrue(intake.pctCommand(-1.0)
+	                                                 ->withTimeout(300_ms)
+	                                                 ->andThen(intake.pctCommand(1.0)->withTimeout(300_ms))
+	                                                 ->repeatedly());
+
+	// Tap each binding once a second, holding the button for 400ms
+	for (std::uint32_t time = 0; time < SIMULATED_MILLISECONDS; time += 1000) {
+		const auto button = std::array{DIGITAL_R1, DIGITAL_R2, DIGITAL_A}[time / 1000 % 3];
+
+		pros::host::script(time + 100, pros::E_CONTROLLER_MASTER, button, true);
+		pros::host::script(time + 500, pros::E_CONTROLLER_MASTER, button, false);
+	}
+
+	SchedulerRunner runner(10_ms);
+	double pctSum = 0.0;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	// The same loop the runner's task uses, on this thread so the virtual clock stays single threaded
+	while (pros::millis() < SIMULATED_MILLISECONDS) {
+		auto start_time = pros::millis();
+
+		runner.tick();
+
+		pctSum += intake.getPct();
+
+		pros::c::task_delay_until(&start_time, 10);
+	}
+
+	const std::uint32_t ticks = runner.getTicks();
+
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::printf("Simulated %u ticks (%.0f s) in %.3f s of wall time, %.0fx real time\n", ticks,
+	            SIMULATED_MILLISECONDS / 1000.0, elapsed.count(),
+	            SIMULATED_MILLISECONDS / 1000.0 / elapsed.count());
+	std::printf("Average intake power %.3f\n", pctSum / ticks);
+	std::printf("%.1f PROS API calls per tick\n", static_cast<double>(pros::host::getCalls()) / ticks);
+	std::printf("Period %u-%u us, mean jitter %.1f us, %u overruns, %u late ticks\n", runner.getMinPeriod(),
+	            runner.getMaxPeriod(), runner.getMeanJitter(), runner.getOverruns(), runner.getLateTicks());
+
+	std::puts("Most expensive commands by total time:");
+	for (const auto command : CommandProfiler::getTop(3, ProfileMetric::Total)) {
+		const ExecutionProfile &profile = command->getProfile();
+
+		std::printf("  %u runs, %llu us total, %.2f us mean, %u us p99, %u us max\n", profile.getCount(),
+		            static_cast<unsigned long long>(profile.getTotal()), profile.getMean(), profile.getP99(),
+		            profile.getMax());
+		std::printf("    execute %llu us, isFinished %llu us, end %llu us\n",
+		            static_cast<unsigned long long>(command->getPhaseProfile(ProfilePhase::Execute).getTotal()),
+		            static_cast<unsigned long long>(command->getPhaseProfile(ProfilePhase::IsFinished).getTotal()),
+		            static_cast<unsigned long long>(command->getPhaseProfile(ProfilePhase::End).getTotal()));
+	}
+
+	return 0;
+}
@@ -0,0 +1,252 @@
+#include <cstdio>
+#include "api.h"
+#include "command/includes.h"
+
+using namespace units;
+
+// Failed checks so far, main exits with an error if there are any
+static int failures = 0;
+
+#define CHECK(condition)                                                                                              \
+	do {                                                                                                              \
+		if (!(condition)) {                                                                                           \
+			std::printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);                              \
+			failures++;                                                                                               \
+		}                                                                                                             \
+	} while (false)
+
+class TestSubsystem : public Subsystem {
+public:
+	void periodic() override {}
+};
+
+// Command that finishes after running execute a number of times
+class CountingCommand : public Command {
+private:
+	std::vector<Subsystem *> requirements;
+	int length;
+
+public:
+	int runs = 0;
+
+	CountingCommand(const int length, std::vector<Subsystem *> requirements)
+		: requirements(std::move(requirements)), length(length) {}
+
+	void initialize() override { runs = 0; }
+
+	void execute() override { runs++; }
+
+	bool isFinished() override { return runs >= length; }
+
+	std::vector<Subsystem *> getRequirements() override { return requirements; }
+};
+
+void setUp() {
+	CommandScheduler::reset();
+	pros::host::reset();
+}
+
+void tick() {
+	CommandScheduler::run();
+	pros::host::advance(10);
+}
+
+// Tick until the command is no longer scheduled, returning the number of ticks it took
+int runUntilDone(Command *command, const int limit = 100) {
+	int ticks = 0;
+
+	while (command->scheduled() && ticks < limit) {
+		tick();
+		ticks++;
+	}
+
+	return ticks;
+}
+
+// CoroutineCommand, ProxyCommand and ScheduleCommand inside groups run on the scheduler task with a WorkerPool set
+void testSerialCommandsWithWorkers() {
+	std::puts("Serial commands with a worker pool");
+
+	setUp();
+
+	WorkerPool pool(2);
+	CommandScheduler::setWorkerPool(&pool);
+
+	TestSubsystem first, second;
+
+	// An awaited command, which checks its requirements against the coroutine command on the scheduler task
+	CountingCommand awaited(3, {&first});
+	CoroutineCommand routine([&awaited]() -> Routine { co_await &awaited; }, {&first});
+	Command *coroutineGroup = (new InstantCommand([]() {}, {}))->andThen(&routine);
+
+	// A proxy has to see its command scheduled on the next check instead of queued
+	CountingCommand proxied(3, {&second});
+	Command *proxyGroup = (new InstantCommand([]() {}, {}))->andThen(proxied.asProxy());
+
+	CountingCommand target(1, {});
+	Command *scheduleGroup = (new ScheduleCommand(&target))->with(new InstantCommand([]() {}, {}));
+
+	coroutineGroup->schedule();
+	proxyGroup->schedule();
+	scheduleGroup->schedule();
+
+	runUntilDone(coroutineGroup);
+	CHECK(awaited.runs == 3);
+	CHECK(CoroutinePool::getInUse() == 0);
+
+	runUntilDone(proxyGroup);
+	CHECK(proxied.runs == 3);
+	CHECK(!proxied.scheduled());
+
+	runUntilDone(scheduleGroup);
+	runUntilDone(&target);
+	CHECK(target.runs == 1);
+
+	CommandScheduler::setWorkerPool(nullptr);
+}
+
+// The controller snapshot is sampled every tick, while button triggers only run their commands in teleop
+void testControllerSampledOutsideTeleop() {
+	std::puts("Controller sampled outside teleop");
+
+	setUp();
+	pros::host::setMode(pros::host::Mode::Autonomous);
+
+	CommandController primary(pros::E_CONTROLLER_MASTER);
+
+	CountingCommand pressed(1, {});
+	primary.getTrigger(pros::E_CONTROLLER_DIGITAL_A)->onTrue(&pressed);
+	CHECK(primary.getAnalog(pros::E_CONTROLLER_ANALOG_LEFT_Y) == 0);
+
+	pros::host::setAnalog(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_ANALOG_LEFT_Y, 100);
+	pros::host::setDigital(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_DIGITAL_A, true);
+	tick();
+
+	CHECK(primary.getAnalog(pros::E_CONTROLLER_ANALOG_LEFT_Y) == 100);
+	CHECK(primary.getDigital(pros::E_CONTROLLER_DIGITAL_A));
+	CHECK(!pressed.scheduled());
+
+	pros::host::setMode(pros::host::Mode::Disabled);
+	pros::host::setAnalog(pros::E_CONTROLLER_MASTER, pros::E_CONTROLLER_ANALOG_LEFT_Y, -50);
+	tick();
+
+	CHECK(primary.getAnalog(pros::E_CONTROLLER_ANALOG_LEFT_Y) == -50);
+}
+
+// Resetting an arena removes its bindings, and with them the conditions and nodes no trigger or binding uses anymore
+void testArenaBindingsFreeConditions() {
+	std::puts("Arena bindings free their conditions");
+
+	setUp();
+
+	EventLoop *loop = CommandScheduler::getEventLoop();
+	const size_t nodes = loop->getNodeCount();
+
+	struct Sensor {
+		bool value = false;
+	};
+
+	CommandArena arena;
+	Sensor *sensor;
+	int reads = 0;
+
+	{
+		CommandArena::Scope scope(arena);
+
+		sensor = arena.create<Sensor>();
+		Command *command = CommandArena::make<InstantCommand>([]() {}, std::initializer_list<Subsystem *>{});
+
+		Trigger([sensor, &reads]() {
+			reads++;
+			return sensor->value;
+		}).debounce(20_ms).onTrue(command);
+
+		(!Trigger([sensor]() { return sensor->value; })).onFalse(command);
+	}
+
+	tick();
+	CHECK(reads > 0);
+	CHECK(loop->getNodeCount() == nodes + 4);
+
+	arena.reset();
+	reads = 0;
+	tick();
+	tick();
+
+	CHECK(reads == 0);
+	CHECK(loop->getNodeCount() == nodes);
+
+	// A trigger that is still around keeps its node after its bindings are removed, and the freed slots are reused
+	Trigger held([&reads]() {
+		reads++;
+		return false;
+	});
+	CountingCommand command(1, {});
+	loop->unbind(held.bind(TriggerMode::OnTrue, &command));
+
+	reads = 0;
+	tick();
+	CHECK(reads == 1);
+	CHECK(loop->getNodeCount() == nodes + 1);
+}
+
+// withTimeout and until return a new command each call and leave the receiver unchanged
+void testTimeoutsOnDistinctCommands() {
+	std::puts("Timeouts on distinct commands");
+
+	setUp();
+
+	CountingCommand command(1000, {});
+	Command *shortTimeout = command.withTimeout(100_ms);
+	Command *longTimeout = command.withTimeout(500_ms);
+
+	CHECK(shortTimeout != &command);
+	CHECK(longTimeout != &command);
+	CHECK(shortTimeout != longTimeout);
+	CHECK(command.getTimeout() == UINT64_MAX);
+	CHECK(shortTimeout->getTimeout() == 100000);
+	CHECK(longTimeout->getTimeout() == 500000);
+
+	shortTimeout->schedule();
+	const int shortTicks = runUntilDone(shortTimeout);
+
+	longTimeout->schedule();
+	const int longTicks = runUntilDone(longTimeout);
+
+	CHECK(shortTicks >= 10 && shortTicks <= 12);
+	CHECK(longTicks >= 50 && longTicks <= 52);
+
+	bool stop = false;
+	Command *stopped = command.until([&stop]() { return stop; });
+	CHECK(stopped != &command);
+
+	stopped->schedule();
+	tick();
+	stop = true;
+	runUntilDone(stopped);
+	CHECK(!command.scheduled());
+	CHECK(command.runs < 5);
+
+	// Scheduled on its own, the command still has no limit and runs until it finishes
+	command.schedule();
+	runUntilDone(&command, 2000);
+	CHECK(command.runs == 1000);
+}
+
+/**
+ * Checks scheduler behavior on the host stand-in. Exits with an error if a check failed
+ */
+int main() {
+	testSerialCommandsWithWorkers();
+	testControllerSampledOutsideTeleop();
+	testArenaBindingsFreeConditions();
+	testTimeoutsOnDistinctCommands();
+
+	if (failures != 0) {
+		std::printf("%d checks failed\n", failures);
+		return 1;
+	}
+
+	std::puts("All checks passed");
+	return 0;
+}
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+#include "executionProfile.h"
+#include "inplaceFunction.h"
+#include "requirementMask.h"
+#include "schedulerClock.h"
 #include "subsystem.h"
 #include "units/units.hpp"
 
@@ -10,6 +16,8 @@
  * uninterrupted. Cancel Running caused the currently running command to yield to the newly scheduled command and end
  * interrupted.
  *
+ * The cancel behavior only decides conflicts between commands of the same priority, see Command::withPriority
+ *
  */
 enum class CommandCancelBehavior {
 	/**
@@ -32,8 +40,140 @@ enum class CommandCancelBehavior {
  * \refitem RunCommand for simple Command behaviors, and you can override this class to create more complex
  * behaviors
  *
+ * The decorators such as andThen() and withTimeout() create their commands in the current \refitem CommandArena, or
+ * with new when there is none
+ *
  */
 class Command {
+protected:
+	/**
+	 * @brief Kind of group a decorator created a command as. A group of the same kind holding it runs its commands
+	 * directly instead of through it, see flattenable
+	 */
+	enum class Composition : std::uint8_t { None, Sequence, Parallel, Race };
+
+private:
+	friend class CommandScheduler;
+	friend class CommandProfiler;
+	friend class EventLoop;
+	friend class Routine;
+
+	static constexpr size_t NOT_SCHEDULED = static_cast<size_t>(-1);
+
+	/**
+	 * Index of this command in the \refitem CommandScheduler scheduled list, owned by the scheduler
+	 */
+	size_t schedulerSlot = NOT_SCHEDULED;
+
+	RequirementMask requirementMask;
+	bool requirementMaskCached = false;
+
+	int priority = 0;
+
+	units::QTime period = 0.0 * units::second;
+
+	// execute runs on ticks where the scheduler tick count % rateDivisor == ratePhase, assigned when scheduled
+	std::uint32_t rateDivisor = 1;
+	std::uint32_t ratePhase = 0;
+
+	// Set when the time budget deferred this command, it then runs on the next tick whatever its phase
+	bool overdue = false;
+
+	// Time spent in this command per tick, and in each phase of it, empty unless COMMAND_PROFILING is defined
+	[[no_unique_address]] ExecutionProfile profile;
+	[[no_unique_address]] PhaseProfiles phaseProfiles;
+
+	// Kind of group a decorator created this command as
+	Composition composition = Composition::None;
+
+	static constexpr std::uint64_t NO_TIMEOUT = UINT64_MAX;
+
+	// Limits set by withTimeout and until, checked after isFinished by done(). Times are in the microseconds of
+	// SchedulerClock::now()
+	std::uint64_t timeout = NO_TIMEOUT;
+	std::uint64_t startTime = 0;
+	InplaceFunction<bool()> untilCondition;
+
+	// Set when a limit ended the command, so it is ended interrupted
+	bool limited = false;
+
+	// Set on commands that have to run on the scheduler task when a WorkerPool is set, and on the groups holding them
+	bool serial = false;
+
+protected:
+	/**
+	 * @brief Check if a group can run the commands of a command it holds directly, for groups that flatten the
+	 * decorator groups in them the first time they run
+	 *
+	 * @param command The command held by the group
+	 * @param kind The kind of the group
+	 * @return true if the command was made by a decorator of the same kind and has no timeout or until condition,
+	 * which would be lost by skipping it
+	 */
+	static bool flattenable(const Command &command, const Composition kind) {
+		return command.composition == kind && command.timeout == NO_TIMEOUT && !command.untilCondition;
+	}
+
+	/**
+	 * @brief Record that a group holds a command, keeping the group on the scheduler task if the command has to run
+	 * there
+	 *
+	 * @param group The group or wrapper holding the command
+	 * @param command The command put in the group
+	 */
+	static void hold(Command &group, const Command &command) {
+		group.serial = group.serial || command.serial;
+	}
+
+	/**
+	 * @brief Keep a command on the scheduler task when a \refitem WorkerPool runs commands in parallel, for commands
+	 * that schedule other commands or use state shared between all commands. Call this from the constructor
+	 *
+	 * @param command The command to keep on the scheduler task
+	 */
+	static void runOnSchedulerTask(Command &command) { command.serial = true; }
+
+	/**
+	 * @brief Start the timeout of a command, for groups that call initialize() directly instead of begin()
+	 *
+	 * @param command The command being initialized
+	 */
+	static void startLimits(Command &command) {
+		if (command.timeout != NO_TIMEOUT) {
+			command.startTime = SchedulerClock::now();
+		}
+
+		command.limited = false;
+	}
+
+	/**
+	 * @brief Check the timeout and until condition of a command, for groups that call isFinished() directly instead
+	 * of done()
+	 *
+	 * @param command The command to check, after its isFinished() returned false
+	 * @return true if the command has to end because of its timeout or until condition
+	 */
+	static bool limitReached(Command &command) {
+		command.limited = (command.timeout != NO_TIMEOUT && SchedulerClock::now() - command.startTime > command.timeout) ||
+			(command.untilCondition && command.untilCondition());
+
+		return command.limited;
+	}
+
+	/**
+	 * @brief The interrupted flag to end a command with, for groups that call end() directly instead of finish()
+	 *
+	 * @param command The command being ended
+	 * @param interrupted Whether the group is interrupting the command
+	 * @return true if interrupted or if the timeout or until condition ended the command
+	 */
+	static bool endInterrupted(Command &command, const bool interrupted) {
+		const bool limitedEnd = command.limited;
+		command.limited = false;
+
+		return interrupted || limitedEnd;
+	}
+
 public:
 	/** @brief Called before every time the command is used. Users can override this to create starting behaviors for
 	 * custom commands
@@ -74,6 +214,35 @@ public:
 	 */
 	virtual void end(bool interrupted){};
 
+	/**
+	 * @brief Initialize this command and start its timeout, the \refitem CommandScheduler and groups call this
+	 * instead of initialize()
+	 */
+	void begin() {
+		startLimits(*this);
+		initialize();
+	}
+
+	/**
+	 * @brief Check if this command is finished or has reached its timeout or until condition, the
+	 * \refitem CommandScheduler and groups call this instead of isFinished()
+	 *
+	 * @return true if the command should be ended
+	 */
+	bool done() {
+		return isFinished() || limitReached(*this);
+	}
+
+	/**
+	 * @brief End this command, the \refitem CommandScheduler and groups call this instead of end()
+	 *
+	 * @param interrupted true if the command is being interrupted, it is also ended interrupted when its timeout or
+	 * until condition ended it
+	 */
+	void finish(const bool interrupted) {
+		end(endInterrupted(*this, interrupted));
+	}
+
 	/**
 	 * @brief This function returns the necessary subsystems needed to do run command. The scheduler will work to free
 	 * these requirements before running the behavior to ensure no tasks overlap.
@@ -81,10 +250,41 @@ public:
 	 * @warning You must ensure all subsystems neccesary are captured by this function or else multiple commands will
 	 * overlap and run at the same time
 	 *
+	 * @note This is only called once, the first time the requirements are needed, and the result is cached. The
+	 * requirements of a command can't change after it is first scheduled
+	 *
 	 * @return A vector of all the subsystem requirements for this class
 	 */
 	virtual std::vector<Subsystem *> getRequirements() { return {}; };
 
+	/**
+	 * @brief Get the requirements of this command as a \refitem RequirementMask of \refitem Subsystem IDs, this is
+	 * what the \refitem CommandScheduler uses to detect conflicts
+	 *
+	 * @return Mask with the ID of every \refitem Subsystem returned by getRequirements set
+	 */
+	const RequirementMask &getRequirementMask();
+
+	/**
+	 * @brief Get the timing statistics of this command, see \refitem CommandProfiler
+	 *
+	 * @return Time spent in execute, isFinished and end for each tick this command was run
+	 */
+	[[nodiscard]] const ExecutionProfile &getProfile() const { return profile; }
+
+	/**
+	 * @brief Get the timing statistics of one phase of this command, see \refitem CommandProfiler
+	 *
+	 * @details End is also timed when the command is interrupted or cancelled, the other phases only when the
+	 * \refitem CommandScheduler runs the command
+	 *
+	 * @param phase The phase to get
+	 * @return Time spent in the phase each time it ran
+	 */
+	[[nodiscard]] const ExecutionProfile &getPhaseProfile(const ProfilePhase phase) const {
+		return phaseProfiles[phase];
+	}
+
 	/**
 	 * @brief Returns the cancel behavior for this class, defaults to CommandCancelBehavior::CancelRunning
 	 *
@@ -92,6 +292,58 @@ public:
 	 */
 	virtual CommandCancelBehavior getCancelBehavior() { return CommandCancelBehavior::CancelRunning; };
 
+	/**
+	 * @brief Set the priority of this command, defaults to 0
+	 *
+	 * @details When commands conflict over a subsystem the higher priority command wins, and the
+	 * \refitem CommandCancelBehavior of the running command only decides between commands of equal priority. When the
+	 * \refitem CommandScheduler has a time budget, commands below its essential priority run after all other commands
+	 * and are skipped for the tick once the budget is used up.
+	 *
+	 * ```C
+	 * // LED animations can wait a tick when the loop is running long
+	 * leds->rainbowCommand()->withPriority(-1);
+	 * ```
+	 *
+	 * @param priority Priority of this command, higher is more important
+	 * @return This command
+	 */
+	Command *withPriority(const int priority) {
+		this->priority = priority;
+		return this;
+	}
+
+	/**
+	 * @return The priority of this command, see withPriority
+	 */
+	[[nodiscard]] int getPriority() const { return priority; }
+
+	/**
+	 * @brief Run this command less often than every \refitem CommandScheduler tick
+	 *
+	 * @details The period is rounded to a whole number of scheduler periods, see CommandScheduler::setPeriod.
+	 * execute and isFinished only run on the ticks of that timetable, and commands with the same period are spread
+	 * across different ticks. Commands inside a group run whenever the group runs them, so set the period on the
+	 * outermost command. Changes apply the next time the command is scheduled.
+	 *
+	 * ```C
+	 * // Redraw the screen at 5Hz
+	 * screen->drawCommand()->withPeriod(200_ms);
+	 * ```
+	 *
+	 * @param period Time between calls to execute, 0 to run every tick
+	 * @return This command
+	 */
+	Command *withPeriod(const units::QTime period) {
+		this->period = period;
+		return this;
+	}
+
+	/**
+	 * @return The period set with withPeriod, 0 when the command runs every tick
+	 */
+	[[nodiscard]] units::QTime getPeriod() const { return period; }
+
 	/**
 	 * @brief Schedule this command with the \refitem CommandScheduler
 	 *
@@ -152,6 +404,11 @@ public:
 	/**
 	 * @brief Create a \refitem Sequence with 2 commands
 	 *
+	 * @details This command is never changed, so the start of a chain can still be used elsewhere. A chain of
+	 * andThen() calls is built as nested sequences, one small group per step. The first time the outermost sequence
+	 * runs, it replaces the sequences made by andThen() inside it with their commands, so a chain runs one level deep
+	 * without copying it at every step
+	 *
 	 * @param other The command to run after the current command
 	 * @return A \refitem Sequence with this running first and other running after
 	 */
@@ -160,22 +417,39 @@ public:
 	/**
 	 * @brief Make a timeout on this command
 	 *
-	 * @param duration The maximum running duration of the Command
-	 * @return \refitem ParallelRaceGroup with this and \refitem WaitCommand of the desired duration
+	 * @details The timeout is stored in a new \refitem ParallelRaceGroup holding only this command, and checked after
+	 * isFinished every time the group runs, without a \refitem WaitCommand. Once the duration has passed since the
+	 * group was initialized, this command and the group are ended with interrupted set to true, and the group counts
+	 * as finished to the scheduler or group running it. This command is unchanged, so each call returns a different
+	 * command and this command can be used elsewhere with a different timeout or none.
+	 *
+	 * @param duration The maximum running duration of the Command, rounded to whole microseconds
+	 * @return \refitem ParallelRaceGroup running this command with the timeout
 	 */
 	Command *withTimeout(units::QTime duration);
 
 	/**
 	 * @brief Run the command until a condition is met
 	 *
+	 * @details The condition is stored in a new \refitem ParallelRaceGroup holding only this command, and checked
+	 * after isFinished every time the group runs, like withTimeout. This command is unchanged.
+	 *
 	 * @param isFinish When this condition returns true the command will stop
-	 * @return \refitem ParallelRaceGroup with this and \refitem WaitUntilCommand with the desired isFinish
+	 * @return \refitem ParallelRaceGroup running this command until the condition is met
+	 */
+	Command *until(InplaceFunction<bool()> isFinish);
+
+	/**
+	 * @return The timeout of a group made by withTimeout in microseconds, UINT64_MAX when there is none
 	 */
-	Command *until(const std::function<bool()> &isFinish);
+	[[nodiscard]] std::uint64_t getTimeout() const { return timeout; }
 
 	/**
 	 * @brief Create a \refitem ParallelCommandGroup with this and other
 	 *
+	 * @details The group runs the commands of this directly instead of through it if this is a
+	 * \refitem ParallelCommandGroup made by an earlier with(), like andThen()
+	 *
 	 * @param other Other command for the \refitem ParallelCommandGroup
 	 * @return \refitem ParallelCommandGroup with this and other
 	 */
@@ -184,6 +458,9 @@ public:
 	/**
 	 * @brief Create a \refitem ParallelRaceGroup with this and other
 	 *
+	 * @details The group runs the commands of this directly instead of through it if this is a
+	 * \refitem ParallelRaceGroup made by an earlier race() without a timeout or until condition, like andThen()
+	 *
 	 * @param other Other command for the \refitem ParallelRaceGroup
 	 * @return \refitem ParallelRaceGroup with this and other
 	 */
@@ -205,5 +482,10 @@ public:
 	 */
 	Command *asProxy();
 
+#ifdef COMMAND_PROFILING
+	// Removes the command from the CommandProfiler list, defined in commandProfiler.h
+	virtual ~Command();
+#else
 	virtual ~Command() = default;
+#endif
 };
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include "command.h"
+
+/**
+ * @brief The number of bytes a \refitem CommandArena preallocates, later allocations take larger blocks from the heap
+ * until the arena is reset
+ */
+#ifndef COMMAND_ARENA_SIZE
+#define COMMAND_ARENA_SIZE 4096
+#endif
+
+/**
+ * @brief Bump allocator that owns a set of commands and frees them all at once
+ *
+ * @details While a CommandArena::Scope is alive, the decorators on \refitem Command (andThen, withTimeout, until,
+ * with, race, repeatedly and asProxy) are allocated from its arena instead of the heap. Outside of any scope they fall
+ * back to new, and are never freed. reset() destroys every object in the arena and keeps the preallocated buffer, so
+ * rebuilding the same commands after a reset doesn't allocate.
+ * \refitem Trigger bindings made while a scope is alive also belong to its arena, and reset() removes them before
+ * destroying any command, so the controls can be rebound after a reset.
+ *
+ * A command only stores its own lists, such as the commands of a group or the requirements of a
+ * \refitem FunctionalCommand, in an arena when create() or make() placed the command itself there. Commands built with
+ * new keep their lists on the heap even while a scope is alive, so they can outlive the arena.
+ *
+ * ```C
+ * CommandArena autonomousArena;
+ *
+ * {
+ *     CommandArena::Scope scope(autonomousArena);
+ *
+ *     autonomousCommand = intake->pctCommand(1.0)->withTimeout(500_ms)->andThen(drive->forwardCommand());
+ * }
+ *
+ * // Free the routine before building the next one
+ * autonomousArena.reset();
+ * ```
+ *
+ * @warning Scopes aren't synchronized, only build commands in one task at a time
+ */
+class CommandArena {
+private:
+	// Objects are destroyed in reverse order of creation, command is set when the object is a \refitem Command
+	struct Node {
+		void (*destroy)(void *);
+		void *object;
+		Command *command;
+		Node *next;
+	};
+
+	std::unique_ptr<std::byte[]> buffer;
+	std::pmr::monotonic_buffer_resource resource;
+
+	Node *objects = nullptr;
+	size_t count = 0;
+
+	static inline CommandArena *current = nullptr;
+
+	// The object create() is constructing, so its constructor can find the arena it is placed in
+	struct Placement {
+		const std::byte *object;
+		size_t size;
+		std::pmr::memory_resource *resource;
+	};
+
+	static inline Placement placing{nullptr, 0, nullptr};
+
+public:
+	/**
+	 * @brief Makes an arena the target of decorators for as long as the scope is alive, scopes can be nested
+	 */
+	class Scope {
+	private:
+		CommandArena *previous;
+
+	public:
+		explicit Scope(CommandArena &arena) : previous(current) { current = &arena; }
+
+		Scope(const Scope &) = delete;
+
+		Scope &operator=(const Scope &) = delete;
+
+		~Scope() { current = previous; }
+	};
+
+	/**
+	 * @brief Create an arena, preallocating its buffer
+	 *
+	 * @param size Bytes to preallocate
+	 */
+	explicit CommandArena(const size_t size = COMMAND_ARENA_SIZE)
+		: buffer(std::make_unique<std::byte[]>(size)), resource(buffer.get(), size) {}
+
+	CommandArena(const CommandArena &) = delete;
+
+	CommandArena &operator=(const CommandArena &) = delete;
+
+	/**
+	 * @brief Construct an object in this arena, it lives until the arena is reset
+	 *
+	 * @tparam T Type of the object
+	 * @param args Arguments passed to the constructor of T
+	 * @return The new object, owned by this arena
+	 */
+	template<typename T, typename... Args>
+	T *create(Args &&... args) {
+		void *memory = resource.allocate(sizeof(T), alignof(T));
+
+		// Restored when the constructor returns or throws, constructors can create other objects in turn
+		struct Restore {
+			Placement previous;
+
+			~Restore() { placing = previous; }
+		} restore{placing};
+
+		placing = {static_cast<const std::byte *>(memory), sizeof(T), &resource};
+
+		T *object = new(memory) T(std::forward<Args>(args)...);
+
+		Command *command = nullptr;
+		if constexpr (std::is_base_of_v<Command, T>) {
+			command = object;
+		}
+
+		objects = new(resource.allocate(sizeof(Node), alignof(Node)))
+			Node{[](void *pointer) { static_cast<T *>(pointer)->~T(); }, object, command, objects};
+		count++;
+
+		return object;
+	}
+
+	/**
+	 * @brief Construct a command group from a list of commands in this arena
+	 */
+	template<typename T>
+	T *create(std::initializer_list<Command *> commands) {
+		return create<T, std::initializer_list<Command *>>(std::move(commands));
+	}
+
+	/**
+	 * @brief Construct an object in the arena of the innermost CommandArena::Scope, or with new when there is none
+	 *
+	 * @tparam T Type of the object
+	 * @param args Arguments passed to the constructor of T
+	 * @return The new object
+	 */
+	template<typename T, typename... Args>
+	static T *make(Args &&... args) {
+		if (current != nullptr) {
+			return current->create<T>(std::forward<Args>(args)...);
+		}
+
+		return new T(std::forward<Args>(args)...);
+	}
+
+	/**
+	 * @brief Construct a command group from a list of commands in the current arena, or with new when there is none
+	 */
+	template<typename T>
+	static T *make(std::initializer_list<Command *> commands) {
+		return make<T, std::initializer_list<Command *>>(std::move(commands));
+	}
+
+	/**
+	 * @brief Get the memory resource an object should store its lists in, called by constructors with this
+	 *
+	 * @param object The object being constructed
+	 * @return The resource of the arena create() is placing the object in, or the default resource when the object
+	 * isn't being placed in an arena
+	 */
+	static std::pmr::memory_resource *getResource(const void *object) {
+		const auto *address = static_cast<const std::byte *>(object);
+
+		if (placing.object != nullptr && address >= placing.object && address < placing.object + placing.size) {
+			return placing.resource;
+		}
+
+		return std::pmr::get_default_resource();
+	}
+
+	/**
+	 * @return The arena of the innermost CommandArena::Scope, nullptr when there is none
+	 */
+	static CommandArena *getCurrent() { return current; }
+
+	/**
+	 * @return The number of objects in this arena
+	 */
+	[[nodiscard]] size_t size() const { return count; }
+
+	/**
+	 * @brief Cancel the scheduled commands in this arena, then remove the \refitem Trigger bindings made in its
+	 * scopes, destroy every object and free the memory taken since the buffer was preallocated
+	 *
+	 * @warning Call this from the scheduler task or before the scheduler starts. Bindings to the arena's commands
+	 * that were made outside of its scopes have to be unbound first
+	 */
+	void reset() {
+		for (const Node *node = objects; node != nullptr; node = node->next) {
+			if (node->command != nullptr && node->command->scheduled()) {
+				node->command->cancel();
+
+				// Make sure the cancel wasn't queued for another task
+				assert(!node->command->scheduled());
+			}
+		}
+
+		for (const Node *node = objects; node != nullptr; node = node->next) {
+			node->destroy(node->object);
+		}
+
+		objects = nullptr;
+		count = 0;
+
+		resource.release();
+	}
+
+	~CommandArena() { reset(); }
+};
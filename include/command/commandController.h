@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <optional>
+#include "api.h"
 #include "commandScheduler.h"
 #include "trigger.h"
 
@@ -7,6 +11,17 @@
  * @brief Command Controller overrides pros::Controller and makes it better interface with \refitem Trigger and command
  * based code
  *
+ * @details The buttons with a \refitem Trigger are read once per tick into a packed snapshot, so any number of
+ * bindings on a button cost one firmware call. The analog axes are added to the snapshot once getAnalog() is first
+ * used. The snapshot is taken by a binding on CommandScheduler::getEventLoop(), which is polled every tick in every
+ * competition state before the teleop \refitem EventLoop, so getDigital() and getAnalog() stay current during
+ * autonomous and disabled while the triggers only run their commands in teleop.
+ *
+ * If either event loop is cleared, such as by CommandScheduler::reset(), the controller binds its sampling again and
+ * creates new triggers the next time getTrigger() or getAnalog() is called. Triggers taken before the clear must not
+ * be used after it. Destroying the controller removes its sampling, and triggers still bound to its buttons read as
+ * released from then on.
+ *
  * ```c
  * // Initialize CommandController
  * CommandController primary(pros::E_CONTROLLER_MASTER);
@@ -18,22 +33,155 @@
  * ```
  */
 class CommandController : public pros::Controller {
+private:
+	static constexpr size_t BUTTONS = 12;
+	static constexpr size_t AXES = 4;
+	static constexpr size_t CONTROLLERS = 2;
+
+	// Button snapshot of each controller ID, bit i is button DIGITAL_L1 + i. Kept outside the controllers so trigger
+	// conditions never read a destroyed controller
+	static inline std::array<std::uint16_t, CONTROLLERS> digital{};
+
+	size_t slot;
+	std::uint16_t sampledButtons = 0;
+
+	std::array<std::int32_t, AXES> analog{};
+	bool sampleAnalog = false;
+
+	std::array<std::optional<Trigger>, BUTTONS> triggers;
+
+	// The triggers are on the teleop event loop, the sampling binding is on the scheduler's event loop
+	EventLoop *eventLoop;
+	EventLoop *sampleLoop;
+	BindingHandle sampleBinding;
+	std::uint32_t clearCount;
+
+	static size_t index(const pros::controller_digital_e_t button) {
+		return static_cast<size_t>(button - pros::E_CONTROLLER_DIGITAL_L1);
+	}
+
+	void sample() {
+		std::uint16_t bits = 0;
+
+		for (size_t i = 0; i < BUTTONS; i++) {
+			if ((sampledButtons >> i & 1) != 0 &&
+			    get_digital(static_cast<pros::controller_digital_e_t>(pros::E_CONTROLLER_DIGITAL_L1 + i))) {
+				bits |= static_cast<std::uint16_t>(1u << i);
+			}
+		}
+
+		// Only touch this controller's buttons, another controller with the same ID may sample others
+		digital[slot] = static_cast<std::uint16_t>((digital[slot] & ~sampledButtons) | bits);
+
+		if (sampleAnalog) {
+			for (size_t i = 0; i < AXES; i++) {
+				analog[i] = get_analog(static_cast<pros::controller_analog_e_t>(i));
+			}
+		}
+	}
+
+	// Clearing an event loop removes the sampling binding or the trigger nodes, bind again what was removed
+	void rebindIfCleared() {
+		if (eventLoop->getClearCount() != clearCount) {
+			clearCount = eventLoop->getClearCount();
+
+			// The nodes are already gone, the triggers see the clear and don't release them
+			for (auto &trigger : triggers) {
+				trigger.reset();
+			}
+
+			digital[slot] = static_cast<std::uint16_t>(digital[slot] & ~sampledButtons);
+			sampledButtons = 0;
+		}
+
+		if (!sampleLoop->isBound(sampleBinding)) {
+			sampleBinding = sampleLoop->bind([this]() { sample(); });
+		}
+	}
+
 public:
 	/**
-	 * @brief Construct a new CommandController
+	 * @brief Construct a new CommandController, sampling it every scheduler tick
 	 *
 	 * @param id Master, Partner controller ID
 	 */
-	explicit CommandController(const pros::controller_id_e_t id) : Controller(id) {}
+	explicit CommandController(const pros::controller_id_e_t id)
+		: Controller(id), slot(static_cast<size_t>(id)), eventLoop(CommandScheduler::getTeleopEventLoop()),
+		  sampleLoop(CommandScheduler::getEventLoop()), clearCount(eventLoop->getClearCount()) {
+		sampleBinding = sampleLoop->bind([this]() { sample(); });
+	}
+
+	// The scheduler's event loop keeps a pointer to this controller
+	CommandController(const CommandController &) = delete;
+
+	CommandController &operator=(const CommandController &) = delete;
 
 	/**
-	 * @brief Create trigger from button
+	 * @brief Get the trigger of a button, the same \refitem Trigger is returned every time for a button
 	 *
-	 * @param button The button to create a \refitem Trigger on
-	 * @return \refitem Trigger with the boolean as the desired button
+	 * @param button The button to get the \refitem Trigger of
+	 * @return \refitem Trigger that is true while the button is pressed, owned by this controller
 	 */
-	Trigger *getTrigger(pros::controller_digital_e_t button) {
-		return new Trigger([this, button]() { return this->get_digital(button); },
-						   CommandScheduler::getTeleopEventLoop());
+	Trigger *getTrigger(const pros::controller_digital_e_t button) {
+		rebindIfCleared();
+
+		const size_t i = index(button);
+
+		if (!triggers[i].has_value()) {
+			const auto bit = static_cast<std::uint16_t>(1u << i);
+
+			// Take the button's current state so the trigger doesn't see a press before the first sample
+			if (get_digital(button)) {
+				digital[slot] |= bit;
+			} else {
+				digital[slot] = static_cast<std::uint16_t>(digital[slot] & ~bit);
+			}
+			sampledButtons |= bit;
+
+			triggers[i].emplace([slot = slot, bit]() { return (digital[slot] & bit) != 0; }, eventLoop);
+		}
+
+		return &*triggers[i];
+	}
+
+	/**
+	 * @brief Get a button from the snapshot taken this tick, in any competition state
+	 *
+	 * @param button The button to read, it must have a \refitem Trigger from getTrigger()
+	 * @return true if the button was pressed when the controller was last sampled
+	 */
+	[[nodiscard]] bool getDigital(const pros::controller_digital_e_t button) const {
+		return (digital[slot] >> index(button) & 1) != 0;
+	}
+
+	/**
+	 * @brief Get an analog axis from the snapshot taken this tick, in any competition state
+	 *
+	 * @details The first call reads the controller directly and adds the axes to the snapshot from then on
+	 *
+	 * @param axis The axis to read
+	 * @return Axis value from -127 to 127 when the controller was last sampled
+	 */
+	std::int32_t getAnalog(const pros::controller_analog_e_t axis) {
+		rebindIfCleared();
+
+		if (!sampleAnalog) {
+			sampleAnalog = true;
+
+			for (size_t i = 0; i < AXES; i++) {
+				analog[i] = get_analog(static_cast<pros::controller_analog_e_t>(i));
+			}
+		}
+
+		return analog[axis];
+	}
+
+	/**
+	 * @brief Stop sampling the controller, triggers bound to its buttons read as released
+	 */
+	~CommandController() {
+		sampleLoop->unbind(sampleBinding);
+
+		digital[slot] = static_cast<std::uint16_t>(digital[slot] & ~sampledButtons);
 	}
 };
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "command.h"
+#include "executionProfile.h"
+
+/**
+ * @brief The number of distinct commands the \refitem CommandProfiler keeps track of, later commands are still
+ * profiled but not listed by getTop()
+ */
+#ifndef COMMAND_PROFILER_CAPACITY
+#define COMMAND_PROFILER_CAPACITY 128
+#endif
+
+/**
+ * @brief Statistic used to rank commands in \refitem CommandProfiler
+ */
+enum class ProfileMetric {
+	Mean,
+	Max,
+	P99,
+	Total,
+};
+
+/**
+ * @brief Lists the most expensive commands run by the \refitem CommandScheduler
+ *
+ * @details Commands are added the first time they are scheduled and removed when they are destroyed, only when
+ * COMMAND_PROFILING is defined. Without it the list isn't compiled in, nothing is tracked and getTop() is always
+ * empty.
+ *
+ * @warning The list isn't synchronized, only schedule, destroy and query commands from the scheduler task
+ */
+class CommandProfiler {
+#ifdef COMMAND_PROFILING
+private:
+	std::array<Command*, COMMAND_PROFILER_CAPACITY> commands{};
+	size_t size = 0;
+
+	static CommandProfiler& getInstance() {
+		static CommandProfiler instance;
+		return instance;
+	}
+
+	static double value(const ExecutionProfile& profile, const ProfileMetric metric) {
+		switch (metric) {
+			case ProfileMetric::Max:
+				return profile.getMax();
+			case ProfileMetric::P99:
+				return profile.getP99();
+			case ProfileMetric::Total:
+				return static_cast<double>(profile.getTotal());
+			case ProfileMetric::Mean:
+			default:
+				return profile.getMean();
+		}
+	}
+#endif
+public:
+	/**
+	 * @brief Add a command to the list, called by the \refitem CommandScheduler when a command is scheduled
+	 *
+	 * @param command The command to track
+	 */
+	static void track(Command* command) {
+#ifdef COMMAND_PROFILING
+		CommandProfiler& instance = getInstance();
+
+		if (!command->profile.tracked && instance.size < instance.commands.size()) {
+			command->profile.tracked = true;
+			instance.commands[instance.size++] = command;
+		}
+#endif
+	}
+
+	/**
+	 * @brief Remove a command from the list, called when a tracked command is destroyed
+	 *
+	 * @param command The command to remove
+	 */
+	static void untrack(Command* command) {
+#ifdef COMMAND_PROFILING
+		if (!command->profile.tracked) {
+			return;
+		}
+
+		CommandProfiler& instance = getInstance();
+
+		for (size_t i = 0; i < instance.size; i++) {
+			if (instance.commands[i] == command) {
+				// Order doesn't matter, getTop() sorts the list
+				instance.commands[i] = instance.commands[--instance.size];
+				break;
+			}
+		}
+
+		command->profile.tracked = false;
+#endif
+	}
+
+	/**
+	 * @brief Get the most expensive commands
+	 *
+	 * @param count The maximum number of commands to return
+	 * @param metric The statistic to sort by
+	 * @return Up to count commands, most expensive first
+	 */
+	static std::vector<Command*> getTop(const size_t count, const ProfileMetric metric = ProfileMetric::Mean) {
+#ifdef COMMAND_PROFILING
+		CommandProfiler& instance = getInstance();
+
+		std::vector<Command*> top(instance.commands.begin(), instance.commands.begin() + instance.size);
+
+		const size_t n = std::min(count, top.size());
+
+		std::partial_sort(top.begin(), top.begin() + n, top.end(), [metric](const Command* a, const Command* b) {
+			return value(a->getProfile(), metric) > value(b->getProfile(), metric);
+		});
+
+		top.resize(n);
+
+		return top;
+#else
+		return {};
+#endif
+	}
+
+	/**
+	 * @brief Clear the samples of every tracked command, keeping them in the list
+	 */
+	static void resetProfiles() {
+#ifdef COMMAND_PROFILING
+		CommandProfiler& instance = getInstance();
+
+		for (size_t i = 0; i < instance.size; i++) {
+			instance.commands[i]->profile.reset();
+			instance.commands[i]->phaseProfiles.reset();
+		}
+#endif
+	}
+
+	/**
+	 * @brief Stop tracking all commands
+	 */
+	static void clear() {
+#ifdef COMMAND_PROFILING
+		CommandProfiler& instance = getInstance();
+
+		for (size_t i = 0; i < instance.size; i++) {
+			instance.commands[i]->profile.tracked = false;
+		}
+
+		instance.size = 0;
+#endif
+	}
+};
+
+#ifdef COMMAND_PROFILING
+inline Command::~Command() {
+	CommandProfiler::untrack(this);
+}
+#endif
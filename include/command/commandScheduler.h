@@ -1,27 +1,377 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
-#include <unordered_map>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "api.h"
 #include "command.h"
+#include "commandProfiler.h"
+#include "executionProfile.h"
+#include "inplaceFunction.h"
+#include "requirementMask.h"
+#include "schedulerClock.h"
 #include "subsystem.h"
 #include "eventLoop.h"
+#include "mpscQueue.h"
+#include "units/units.hpp"
+#include "workerPool.h"
+
+/**
+ * @brief The number of simultaneously scheduled commands the \refitem CommandScheduler preallocates room for
+ */
+#ifndef COMMAND_RESERVED_COMMANDS
+#define COMMAND_RESERVED_COMMANDS 32
+#endif
+
+/**
+ * @brief The number of schedule(), cancel() and registerSubsystem() calls from other tasks the
+ * \refitem CommandScheduler can hold between ticks, a power of two
+ */
+#ifndef COMMAND_REQUEST_QUEUE_CAPACITY
+#define COMMAND_REQUEST_QUEUE_CAPACITY 64
+#endif
+
+/**
+ * @brief Competition mode of the robot, sampled by the \refitem CommandScheduler once per tick
+ */
+enum class CompetitionState : std::uint8_t {
+	Disabled,
+	Autonomous,
+	Teleop,
+};
 
 // Like WPILib's CommandScheduler class
 class CommandScheduler {
 private:
-	std::unordered_map<Subsystem*, Command*> subsystems;
-	std::unordered_map<Subsystem*, Command*> requirements;
+	std::vector<Subsystem*> subsystems;
+	std::array<Command*, RequirementMask::CAPACITY> defaultCommands{};
+	RequirementMask registered;
+
+	// The command currently holding each subsystem ID, only valid where the bit in claimed is set
+	std::array<Command*, RequirementMask::CAPACITY> requiring{};
+	RequirementMask claimed;
+
+	// Registered subsystems no command holds, waiting for their default command. Updated whenever claimed changes
+	RequirementMask idle;
+
+	size_t nextSubsystemId = 0;
+
+	// Slot array of scheduled commands, removed commands leave a nullptr tombstone until the next compact()
 	std::vector<Command*> scheduledCommands;
+	size_t tombstones = 0;
 
 	EventLoop teleopEventLoop{};
 	EventLoop eventLoop{};
 
 	bool inRunLoop = false;
 
-	std::vector<Command*> toSchedule;
-	std::vector<Command*> toCancel;
+	// Time budget of a tick in microseconds, 0 when commands are never deferred
+	std::uint32_t timeBudget = 0;
+	int essentialPriority = 0;
+
+	// Index the next deferrable pass starts from, so the same commands aren't deferred every tick
+	size_t deferrableCursor = 0;
+	size_t deferred = 0;
+
+	// Time between calls to run() in microseconds and the number of ticks so far, used for multi-rate timetables
+	std::uint32_t periodMicros = 10000;
+	std::uint32_t tickCount = 0;
+
+	// Divisor of each rate group and the next phase handed out in it
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> rateGroups;
+
+	// Runs commands in parallel when set, see setWorkerPool
+	WorkerPool* workerPool = nullptr;
+	// Written by the scheduler task and read by workers and user tasks in mustQueue
+	std::atomic<bool> inParallelPhase = false;
+
+	// Slots of the commands that finished in the parallel phase, one byte each so workers never share a write
+	std::vector<std::uint8_t> finished;
+
+	// The task that runs run(), nullptr until the first tick or SchedulerRunner::start()
+	std::atomic<pros::task_t> owner{nullptr};
+
+	enum class RequestAction : std::uint8_t { Schedule, Cancel, Register };
+
+	struct Request {
+		RequestAction action = RequestAction::Schedule;
+		Command* command = nullptr;
+		Subsystem* subsystem = nullptr;
+	};
+
+	// Calls made from other tasks or by commands in the parallel phase, applied in order by the owner
+	MpscQueue<Request, COMMAND_REQUEST_QUEUE_CAPACITY> requests;
+	std::atomic<std::uint32_t> droppedRequests{0};
+
+	// Competition state at the start of the current tick, only valid once competitionSampled is set
+	CompetitionState competitionState = CompetitionState::Disabled;
+	bool competitionSampled = false;
+
+	struct Transition {
+		// Bit s is set if the handler runs when leaving state s
+		std::uint8_t from;
+		CompetitionState to;
+		InplaceFunction<void()> handler;
+	};
+
+	std::vector<Transition> transitions;
+
+	CommandScheduler() {
+		reserveCapacity(COMMAND_RESERVED_COMMANDS);
+		rateGroups.reserve(8);
+	}
+
+	// Number of ticks in a period, periods shorter than a tick run every tick
+	[[nodiscard]] std::uint32_t divisorFor(const units::QTime period) const {
+		const std::uint64_t micros = SchedulerClock::toMicros(period);
+		// Rounded to the nearest tick, halves up
+		const std::uint64_t ticks = micros / periodMicros + (micros % periodMicros >= (periodMicros + 1) / 2 ? 1 : 0);
+
+		return static_cast<std::uint32_t>(std::clamp<std::uint64_t>(ticks, 1, UINT32_MAX));
+	}
+
+	// Spreads the members of a rate group across the ticks of its period
+	std::uint32_t nextPhase(const std::uint32_t divisor) {
+		if (divisor == 1) {
+			return 0;
+		}
+
+		for (auto& [groupDivisor, next] : rateGroups) {
+			if (groupDivisor == divisor) {
+				return next++ % divisor;
+			}
+		}
+
+		// Each new group starts one tick later, so slow groups don't all line up on the same tick
+		const auto offset = static_cast<std::uint32_t>(rateGroups.size());
+		rateGroups.emplace_back(divisor, offset + 1);
+
+		return offset % divisor;
+	}
+
+	[[nodiscard]] bool due(const std::uint32_t divisor, const std::uint32_t phase) const {
+		return divisor == 1 || tickCount % divisor == phase;
+	}
+
+	[[nodiscard]] bool due(const Command* command) const {
+		return command->overdue || due(command->rateDivisor, command->ratePhase);
+	}
+
+	static CompetitionState sampleCompetitionState() {
+		if (pros::competition::is_disabled()) {
+			return CompetitionState::Disabled;
+		}
+
+		return pros::competition::is_autonomous() ? CompetitionState::Autonomous : CompetitionState::Teleop;
+	}
+
+	// The state sampled this tick, or the live state before the first tick
+	[[nodiscard]] CompetitionState currentCompetitionState() const {
+		return competitionSampled ? competitionState : sampleCompetitionState();
+	}
+
+	// Run the handlers of the transition from previous to the state sampled this tick, if the state changed
+	void dispatchTransitions(const CompetitionState previous) {
+		if (competitionState == previous) {
+			return;
+		}
+
+		for (const auto& transition : transitions) {
+			if ((transition.from >> static_cast<std::uint8_t>(previous) & 1) != 0 && transition.to == competitionState) {
+				transition.handler();
+			}
+		}
+	}
+
+	void reserveCapacity(const size_t commands) {
+		scheduledCommands.reserve(commands);
+	}
+
+	void insert(Command* command) {
+		// Reuse tombstoned slots before growing, unless run() is walking the slots
+		if (!inRunLoop && tombstones > 0 && scheduledCommands.size() == scheduledCommands.capacity()) {
+			compact();
+		}
+
+		command->schedulerSlot = scheduledCommands.size();
+		scheduledCommands.push_back(command);
+	}
+
+	// Leaves a tombstone so slot indices stay stable while run() is iterating
+	void remove(Command* command) {
+		scheduledCommands[command->schedulerSlot] = nullptr;
+		command->schedulerSlot = Command::NOT_SCHEDULED;
+		tombstones++;
+	}
+
+	// Removes all tombstones in one pass, keeping the order of the live commands
+	void compact() {
+		size_t live = 0;
+
+		// The deferrable pass resumes from the first live command at or after the cursor
+		size_t cursor = 0;
+
+		for (size_t i = 0; i < scheduledCommands.size(); i++) {
+			if (i == deferrableCursor) {
+				cursor = live;
+			}
+
+			if (Command* command = scheduledCommands[i]; command != nullptr) {
+				command->schedulerSlot = live;
+				scheduledCommands[live++] = command;
+			}
+		}
+
+		scheduledCommands.resize(live);
+		deferrableCursor = cursor;
+		tombstones = 0;
+	}
+
+	// Run one phase of a command, timing it into the phase's profile when COMMAND_PROFILING is defined
+	template<typename F>
+	static auto timed(Command* command, const ProfilePhase phase, F&& function) {
+		ProfileTimer timer(command->phaseProfiles[phase]);
+
+		return function();
+	}
+
+	// Execute a scheduled command, ending and removing it if it finished
+	void update(const size_t slot) {
+		Command* command = scheduledCommands[slot];
+
+		command->overdue = false;
+
+		// One sample per command per tick, covering execute, isFinished and end, which are also timed separately
+		ProfileTimer timer(command->profile);
+
+		timed(command, ProfilePhase::Execute, [command]() { command->execute(); });
+
+		// Skip if the command was cancelled or interrupted by its own execute
+		if (scheduledCommands[slot] != command) {
+			return;
+		}
+
+		if (timed(command, ProfilePhase::IsFinished, [command]() { return command->done(); })) {
+			timed(command, ProfilePhase::End, [command]() { command->finish(false); });
+
+			release(command);
+
+			remove(command);
+		}
+	}
+
+	// Runs on worker tasks, everything that changes the scheduler state is left to runParallel()
+	void updateParallel(const size_t slot) {
+		Command* command = scheduledCommands[slot];
+
+		if (command == nullptr || command->serial || !due(command)) {
+			return;
+		}
+
+		command->overdue = false;
+
+		ProfileTimer timer(command->profile);
+
+		timed(command, ProfilePhase::Execute, [command]() { command->execute(); });
+
+		if (timed(command, ProfilePhase::IsFinished, [command]() { return command->done(); })) {
+			timed(command, ProfilePhase::End, [command]() { command->finish(false); });
+
+			finished[slot] = 1;
+		}
+	}
+
+	void runParallel(const size_t count) {
+		finished.assign(count, 0);
+
+		inParallelPhase.store(true, std::memory_order_release);
+
+		auto job = [this](const size_t slot) { updateParallel(slot); };
+		workerPool->run(count, job);
+
+		inParallelPhase.store(false, std::memory_order_release);
+
+		for (size_t i = 0; i < count; i++) {
+			if (finished[i] != 0) {
+				Command* command = scheduledCommands[i];
+
+				release(command);
+				remove(command);
+			}
+		}
+
+		// Commands that have to run on this task go after the barrier, where schedule() and cancel() apply directly
+		for (size_t i = 0; i < count; i++) {
+			if (const Command* command = scheduledCommands[i]; command != nullptr && command->serial && due(command)) {
+				update(i);
+			}
+		}
+
+		drain();
+	}
+
+	// Whether a call has to go through the request queue instead of changing the scheduler directly
+	[[nodiscard]] bool mustQueue() const {
+		if (inParallelPhase.load(std::memory_order_acquire)) {
+			return true;
+		}
+
+		const pros::task_t task = owner.load(std::memory_order_relaxed);
+
+		return task != nullptr && task != pros::c::task_get_current();
+	}
+
+	void enqueue(const Request& request) {
+		const bool queued = requests.push(request);
+
+		if (!queued) {
+			droppedRequests.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// Make sure there is room for the request, raise COMMAND_REQUEST_QUEUE_CAPACITY if this fails
+		assert(queued);
+	}
 
-	CommandScheduler() = default;
+	// Apply queued calls in the order they were made, only called by the owner
+	void drain() {
+		Request request;
+
+		while (requests.pop(request)) {
+			switch (request.action) {
+				case RequestAction::Schedule:
+					schedule(request.command);
+					break;
+				case RequestAction::Cancel:
+					cancel(request.command);
+					break;
+				case RequestAction::Register:
+					registerSubsystem(request.subsystem, request.command);
+					break;
+			}
+		}
+	}
+
+	static void release(Command* command) {
+		CommandScheduler& instance = getInstance();
+
+		const RequirementMask& requirements = command->getRequirementMask();
+
+		requirements.forEach([&instance, command](const size_t id) {
+			if (instance.requiring[id] == command) {
+				instance.requiring[id] = nullptr;
+				instance.claimed.reset(id);
+
+				if (instance.registered.test(id)) {
+					instance.idle.set(id);
+				}
+			}
+		});
+	}
 public:
 	// Singleton pattern
 	static CommandScheduler& getInstance() {
@@ -29,131 +379,445 @@ public:
 		return instance;
 	}
 
+	/**
+	 * @brief Get the dense ID of a subsystem, assigning the next free one if it doesn't have one yet
+	 *
+	 * @param subsystem The subsystem to get the ID of
+	 * @return ID used as the bit index for this subsystem in \refitem RequirementMask
+	 */
+	static size_t getSubsystemId(Subsystem* subsystem) {
+		CommandScheduler& instance = getInstance();
+
+		// IDs are assigned without synchronization, see onSchedulerTask()
+		assert(onSchedulerTask());
+
+		if (subsystem->id == Subsystem::UNASSIGNED_ID) {
+			// Make sure there is room for another subsystem, raise COMMAND_MAX_SUBSYSTEMS if this fails
+			assert(instance.nextSubsystemId < RequirementMask::CAPACITY);
+
+			subsystem->id = instance.nextSubsystemId++;
+		}
+
+		return subsystem->id;
+	}
+
+	/**
+	 * @brief Preallocate room for a number of simultaneously scheduled commands
+	 *
+	 * @details The scheduler never frees this storage, so once it has room for the most commands that are ever
+	 * scheduled at once, a call to run() that doesn't schedule any command for the first time performs no heap
+	 * allocations
+	 *
+	 * @param commands The number of commands to make room for
+	 */
+	static void reserve(const size_t commands) {
+		getInstance().reserveCapacity(commands);
+	}
+
 	static void registerSubsystem(Subsystem* subsystem, Command* default_command) {
 		CommandScheduler& instance = getInstance();
 
+		if (instance.mustQueue()) {
+			instance.enqueue({RequestAction::Register, default_command, subsystem});
+			return;
+		}
+
+		const size_t id = getSubsystemId(subsystem);
+
 		// Make sure the subsystem isn't already registered
-		assert(!instance.subsystems.contains(subsystem));
+		assert(!instance.registered.test(id));
 
 		// Make sure the default command isn't null
 		assert(default_command != nullptr);
 
-		instance.subsystems[subsystem] = default_command;
+		instance.registered.set(id);
+		if (!instance.claimed.test(id)) {
+			instance.idle.set(id);
+		}
+		subsystem->rateDivisor = instance.divisorFor(subsystem->getPeriod());
+		subsystem->ratePhase = instance.nextPhase(subsystem->rateDivisor);
+		instance.subsystems.emplace_back(subsystem);
+		instance.defaultCommands[id] = default_command;
 	}
 
 	static void schedule(Command* command) {
 		CommandScheduler& instance = getInstance();
 
-		// Return if the command is already scheduled
-		if (scheduled(command)) {
+		// Calls from other tasks or commands running in parallel are applied by the scheduler task
+		if (instance.mustQueue()) {
+			instance.enqueue({RequestAction::Schedule, command});
 			return;
 		}
 
-		if (instance.inRunLoop) {
-			instance.toSchedule.emplace_back(command);
+		// Return if the command is already scheduled
+		if (scheduled(command)) {
+			return;
 		}
 
 		// return if competition is disabled
-		if (pros::competition::is_disabled()) {
+		if (instance.currentCompetitionState() == CompetitionState::Disabled) {
 			return;
 		}
 
-		std::vector<Command*> intersection;
+		const RequirementMask& requirements = command->getRequirementMask();
+		const RequirementMask intersection = requirements & instance.claimed;
 
 		bool all_interruptible = true;
 
-		auto requirements = command->getRequirements();
+		// Higher priority commands always win, the cancel behavior decides between equal priorities
+		intersection.forEach([&instance, &all_interruptible, command](const size_t id) {
+			Command* running = instance.requiring[id];
 
-	    for (auto requirement : instance.requirements) {
-	    	if (find(requirements.begin(), requirements.end(), requirement.first) != requirements.end()) {
-	            all_interruptible &= requirement.second->getCancelBehavior() == CommandCancelBehavior::CancelRunning;
-	    		intersection.push_back(requirement.second);
-	        }
-	    }
+			all_interruptible &= running->priority < command->priority ||
+				(running->priority == command->priority &&
+				 running->getCancelBehavior() == CommandCancelBehavior::CancelRunning);
+		});
 
 		if (all_interruptible) {
-			for (auto intersect : intersection) {
-				intersect->end(true);
-				std::erase(instance.scheduledCommands, intersect);
-			}
+			intersection.forEach([&instance](const size_t id) {
+				// A command holding several of the intersecting subsystems is only ended once
+				if (Command* intersect = instance.requiring[id]; intersect != nullptr) {
+					timed(intersect, ProfilePhase::End, [intersect]() { intersect->finish(true); });
+					instance.remove(intersect);
+					release(intersect);
+				}
+			});
 
-			for (auto requirement : requirements) {
-				instance.requirements[requirement] = command;
-			}
+			requirements.forEach([&instance, command](const size_t id) {
+				instance.requiring[id] = command;
+			});
+			instance.claimed |= requirements;
+			instance.idle &= ~requirements;
+
+#ifdef COMMAND_PROFILING
+			CommandProfiler::track(command);
+#endif
 
-			command->initialize();
+			command->rateDivisor = instance.divisorFor(command->period);
+			command->ratePhase = instance.nextPhase(command->rateDivisor);
+			command->overdue = false;
 
-			instance.scheduledCommands.push_back(command);
+			command->begin();
+
+			instance.insert(command);
 		}
 	}
 
+	/**
+	 * @brief Get the command holding a subsystem, only call this from the scheduler task, see onSchedulerTask()
+	 *
+	 * @param subsystem The subsystem to look up
+	 * @return The command requiring the subsystem, if there is one
+	 */
 	static std::optional<Command*> getRequiring(Subsystem* subsystem) {
 		CommandScheduler& instance = getInstance();
 
-		if (instance.requirements.find(subsystem) != instance.requirements.end()) {
-			return instance.requirements[subsystem];
+		// The requirements are changed by the scheduler task without synchronization
+		assert(onSchedulerTask());
+
+		const size_t id = getSubsystemId(subsystem);
+
+		if (instance.claimed.test(id)) {
+			return instance.requiring[id];
 		}
 
 		return std::nullopt;
 	}
 
+	/**
+	 * @brief Set the time between calls to run(), used to turn subsystem and command periods into ticks
+	 *
+	 * @details \refitem SchedulerRunner sets this to its own period. Set it before registering subsystems, the
+	 * periods of already registered subsystems and scheduled commands aren't recalculated
+	 *
+	 * @param period Time between calls to run(), defaults to 10ms
+	 */
+	static void setPeriod(const units::QTime period) {
+		getInstance().periodMicros =
+			static_cast<std::uint32_t>(std::clamp<std::uint64_t>(SchedulerClock::toMicros(period), 1, UINT32_MAX));
+	}
+
+	/**
+	 * @return The time between calls to run() in microseconds
+	 */
+	static std::uint32_t getPeriodMicros() {
+		return getInstance().periodMicros;
+	}
+
+	/**
+	 * @brief Run scheduled commands in parallel on a \refitem WorkerPool, or serially again with nullptr
+	 *
+	 * @details Scheduled commands never share a requirement, so each one is its own partition and the commands of a
+	 * tick are spread across the pool with a barrier at the end. Subsystem periodics, event loops and default commands
+	 * still run on the calling task. Commands must only touch state owned by their requirements, or synchronize it
+	 * themselves.
+	 *
+	 * While commands run in parallel, schedule() and cancel() calls are queued and applied in order after the
+	 * barrier, so scheduled() doesn't reflect them until then, and execute and end run on worker tasks. Commands that
+	 * schedule other commands or share state with every command, such as \refitem ProxyCommand,
+	 * \refitem ScheduleCommand and \refitem CoroutineCommand, and the groups holding them, run on the calling task
+	 * after the barrier instead. The time budget isn't applied while a pool is set.
+	 *
+	 * @param pool The pool to use, owned by the caller and kept alive while set
+	 */
+	static void setWorkerPool(WorkerPool* pool) {
+		CommandScheduler& instance = getInstance();
+
+		instance.workerPool = pool;
+		instance.finished.reserve(instance.scheduledCommands.capacity());
+	}
+
+	/**
+	 * @brief Set the task that runs run(), calls to schedule(), cancel() and registerSubsystem() from any other task
+	 * are queued and applied at the start of the next tick
+	 *
+	 * @details The first call to run() sets this to its task if it isn't set yet, and \refitem SchedulerRunner sets
+	 * it to its own task when started. Until then calls change the scheduler directly, so do single task setup
+	 * before the scheduler starts running. \refitem EventLoop bindings, getSubsystemId() and getRequiring() aren't
+	 * queued, so only use them before starting the scheduler or from the scheduler task, see onSchedulerTask().
+	 * scheduled() isn't synchronized, from other tasks it only gives a snapshot that may be a tick old.
+	 *
+	 * @param task The scheduler task
+	 */
+	static void setOwner(const pros::task_t task) {
+		getInstance().owner.store(task, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Check whether the calling task can use the parts of the scheduler that aren't queued
+	 *
+	 * @return true before the scheduler has an owner, or on the owner task outside of the parallel phase of a
+	 * \refitem WorkerPool
+	 */
+	[[nodiscard]] static bool onSchedulerTask() {
+		return !getInstance().mustQueue();
+	}
+
+	/**
+	 * @return The number of schedule(), cancel() and registerSubsystem() calls from other tasks that were dropped
+	 * because the request queue was full, raise COMMAND_REQUEST_QUEUE_CAPACITY if this isn't 0
+	 */
+	static std::uint32_t getDroppedRequests() {
+		return getInstance().droppedRequests.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Limit how long a tick can spend on low priority commands
+	 *
+	 * @details Commands with a priority of at least essentialPriority always run, before any other command. The
+	 * remaining commands run after them in a rotating order, and once a tick has taken budget microseconds since the
+	 * start of run() the rest are deferred to the next tick.
+	 *
+	 * @param budget Microseconds per tick, 0 to disable the budget and run every command in schedule order
+	 * @param essentialPriority Lowest priority that is never deferred
+	 */
+	static void setTimeBudget(const std::uint32_t budget, const int essentialPriority = 0) {
+		CommandScheduler& instance = getInstance();
+
+		instance.timeBudget = budget;
+		instance.essentialPriority = essentialPriority;
+	}
+
+	/**
+	 * @brief Get the competition state sampled at the start of the current tick
+	 *
+	 * @details Before the first tick the state is read from the firmware on every call
+	 */
+	static CompetitionState getCompetitionState() {
+		return getInstance().currentCompetitionState();
+	}
+
+	/**
+	 * @brief Run a handler at the start of the tick where the competition state changes from one state to another
+	 *
+	 * @details Handlers run after queued calls are applied and before subsystem periodics, in the order they were
+	 * added. The state before the first tick counts as disabled, so a robot that starts enabled runs the handlers of
+	 * that transition on its first tick. Add handlers before the scheduler starts running or from the scheduler task.
+	 *
+	 * ```C
+	 * // Start the autonomous routine the moment the field enables the robot
+	 * CommandScheduler::onTransition(CompetitionState::Disabled, CompetitionState::Autonomous, autonomousCommand);
+	 * ```
+	 *
+	 * @param from State the robot leaves
+	 * @param to State the robot enters
+	 * @param handler Function run on the transition
+	 */
+	static void onTransition(const CompetitionState from, const CompetitionState to, InplaceFunction<void()> handler) {
+		getInstance().transitions.push_back({static_cast<std::uint8_t>(1u << static_cast<std::uint8_t>(from)), to,
+		                                     std::move(handler)});
+	}
+
+	/**
+	 * @brief Schedule a command at the start of the tick where the competition state changes from one state to
+	 * another
+	 *
+	 * @param from State the robot leaves
+	 * @param to State the robot enters
+	 * @param command The command to schedule, it isn't scheduled when entering the disabled state
+	 */
+	static void onTransition(const CompetitionState from, const CompetitionState to, Command* command) {
+		onTransition(from, to, [command]() { schedule(command); });
+	}
+
+	/**
+	 * @brief Run a handler at the start of the tick where the robot enters a competition state from any other
+	 *
+	 * @param state State the robot enters
+	 * @param handler Function run on the transition
+	 */
+	static void onEnter(const CompetitionState state, InplaceFunction<void()> handler) {
+		getInstance().transitions.push_back({UINT8_MAX, state, std::move(handler)});
+	}
+
+	/**
+	 * @brief Schedule a command at the start of the tick where the robot enters a competition state from any other
+	 *
+	 * @param state State the robot enters
+	 * @param command The command to schedule, it isn't scheduled when entering the disabled state
+	 */
+	static void onEnter(const CompetitionState state, Command* command) {
+		onEnter(state, [command]() { schedule(command); });
+	}
+
+	/**
+	 * @brief Get the time sampled at the start of the current tick, the time \refitem WaitCommand, withTimeout and
+	 * debounced \refitem Trigger s measure with
+	 *
+	 * @details Before the first tick the clock is read on every call
+	 *
+	 * @return Microseconds from the clock set with setClock(), pros::micros() by default
+	 */
+	static std::uint64_t now() {
+		return SchedulerClock::now();
+	}
+
+	/**
+	 * @brief Replace the clock the scheduler samples every tick, see \refitem SchedulerClock
+	 *
+	 * @details The time budget and \refitem SchedulerRunner keep measuring with pros::micros(), since they track how
+	 * long the code really takes. Set the clock before the scheduler starts running or from the scheduler task.
+	 *
+	 * @param clock Function returning monotonic microseconds, nullptr to go back to pros::micros()
+	 */
+	static void setClock(const SchedulerClock::Source clock) {
+		SchedulerClock::setSource(clock);
+	}
+
+	/**
+	 * @return The number of commands deferred by the time budget in the last tick
+	 */
+	static size_t getDeferredCount() {
+		return getInstance().deferred;
+	}
+
 	static void run() {
 		CommandScheduler& instance = getInstance();
 
+		if (instance.owner.load(std::memory_order_relaxed) == nullptr) {
+			setOwner(pros::c::task_get_current());
+		}
+
+		// Every time-based command and check of the competition state this tick uses these samples
+		SchedulerClock::sample();
+
+		const CompetitionState previous = instance.competitionState;
+		instance.competitionState = sampleCompetitionState();
+		instance.competitionSampled = true;
+
+		// Apply the calls other tasks made since the last tick
+		instance.drain();
+
+		instance.dispatchTransitions(previous);
+
+		const std::uint64_t tickStart = instance.timeBudget > 0 ? pros::micros() : 0;
+
 		// Run the periodic for all registered subsystems
-		for (const auto subsystem: instance.subsystems | std::views::keys) {
-			subsystem->periodic();
+		for (const auto subsystem: instance.subsystems) {
+			if (instance.due(subsystem->rateDivisor, subsystem->ratePhase)) {
+				ProfileTimer timer(subsystem->profile);
+
+				subsystem->periodic();
+			}
 		}
 
 		// Poll user set event loops
 		instance.eventLoop.poll();
 
 		// Only poll teleop tasks when the robot controller is active (Controller buttons)
-		if (!pros::competition::is_autonomous() && !pros::competition::is_disabled()) {
+		if (instance.competitionState == CompetitionState::Teleop) {
 			instance.teleopEventLoop.poll();
 		}
 
 		instance.inRunLoop = true;
 
-		for (auto command : instance.scheduledCommands) {
-			command->execute();
+		// Commands scheduled while iterating are appended past count, and start executing next tick
+		const size_t count = instance.scheduledCommands.size();
+
+		instance.deferred = 0;
+
+		if (instance.workerPool != nullptr) {
+			instance.runParallel(count);
+		} else if (instance.timeBudget == 0) {
+			for (size_t i = 0; i < count; i++) {
+				if (const Command* command = instance.scheduledCommands[i];
+					command != nullptr && instance.due(command)) {
+					instance.update(i);
+				}
+			}
+		} else {
+			for (size_t i = 0; i < count; i++) {
+				if (const Command* command = instance.scheduledCommands[i];
+					command != nullptr && command->priority >= instance.essentialPriority && instance.due(command)) {
+					instance.update(i);
+				}
+			}
+
+			const size_t start = count == 0 ? 0 : instance.deferrableCursor % count;
+			bool overBudget = false;
 
-			if (command->isFinished()) {
-				command->end(false);
+			for (size_t n = 0; n < count; n++) {
+				const size_t i = (start + n) % count;
 
-				for (auto requirement : command->getRequirements()) {
-					instance.requirements.erase(requirement);
+				if (const Command* command = instance.scheduledCommands[i];
+					command == nullptr || command->priority >= instance.essentialPriority || !instance.due(command)) {
+					continue;
 				}
 
-				std::erase(instance.scheduledCommands, command);
+				overBudget = overBudget || pros::micros() - tickStart >= instance.timeBudget;
+
+				if (overBudget) {
+					// The first deferred command goes first next tick, and slower commands don't wait for their phase
+					if (instance.deferred++ == 0) {
+						instance.deferrableCursor = i;
+					}
+
+					instance.scheduledCommands[i]->overdue = true;
+				} else {
+					instance.update(i);
+				}
 			}
 		}
 
 		instance.inRunLoop = false;
 
-		for (const auto command : instance.toCancel) {
-			cancel(command);
+		if (instance.tombstones > 0) {
+			instance.compact();
 		}
 
-		for (const auto command : instance.toSchedule) {
-			schedule(command);
-		}
+		// Only subsystems released since their default command last ran are visited. Iterate a copy, scheduling a
+		// default command claims its subsystems
+		const RequirementMask waiting = instance.idle;
 
-		instance.toCancel.clear();
-		instance.toSchedule.clear();
+		waiting.forEach([&instance](const size_t id) {
+			schedule(instance.defaultCommands[id]);
+		});
 
-		for (auto [subsystem, command] : instance.subsystems) {
-			if (!instance.requirements.contains(subsystem)) {
-				schedule(command);
-			}
-		}
+		instance.tickCount++;
 	}
 
 	static bool scheduled(const Command* command) {
-		CommandScheduler& instance = getInstance();
-
-		return std::find(instance.scheduledCommands.begin(), instance.scheduledCommands.end(), command) != instance.
-		       scheduledCommands.end();
+		return command->schedulerSlot != Command::NOT_SCHEDULED;
 	}
 
 	static EventLoop* getEventLoop() {
@@ -171,19 +835,71 @@ public:
 	static void cancel(Command* command) {
 		CommandScheduler& instance = getInstance();
 
-		if (instance.inRunLoop) {
-			instance.toCancel.emplace_back(command);
+		if (instance.mustQueue()) {
+			instance.enqueue({RequestAction::Cancel, command});
+			return;
 		}
 
 		if (scheduled(command)) {
-			command->end(true);
+			timed(command, ProfilePhase::End, [command]() { command->finish(true); });
+
+			instance.remove(command);
 
-			std::erase(instance.scheduledCommands, command);
+			release(command);
+		}
+	}
+
+	/**
+	 * @brief Cancel every scheduled command, unregister all subsystems, clear both event loops, remove the time
+	 * budget, worker pool, owner task and competition transition handlers and restart the multi-rate timetable
+	 *
+	 * @details Subsystem IDs are handed out from zero again, so subsystems used before the reset must not be used
+	 * after it. The \refitem CommandProfiler stops tracking all commands. The clock set with setClock() is kept. This
+	 * is meant for simulations and benchmarks that set up many robots in one program.
+	 */
+	static void reset() {
+		CommandScheduler& instance = getInstance();
 
-			for (auto requirement : command->getRequirements()) {
-				instance.requirements.erase(requirement);
+		for (const auto command : instance.scheduledCommands) {
+			if (command != nullptr) {
+				cancel(command);
 			}
 		}
+		instance.compact();
+
+		for (const auto subsystem : instance.subsystems) {
+			subsystem->id = Subsystem::UNASSIGNED_ID;
+		}
+		instance.subsystems.clear();
+		instance.defaultCommands = {};
+		instance.registered = {};
+		instance.requiring = {};
+		instance.claimed = {};
+		instance.idle = {};
+		instance.nextSubsystemId = 0;
+		instance.timeBudget = 0;
+		instance.essentialPriority = 0;
+		instance.deferrableCursor = 0;
+		instance.deferred = 0;
+		instance.tickCount = 0;
+		instance.rateGroups.clear();
+		instance.workerPool = nullptr;
+		instance.owner.store(nullptr, std::memory_order_relaxed);
+		instance.competitionState = CompetitionState::Disabled;
+		instance.competitionSampled = false;
+		instance.transitions.clear();
+		SchedulerClock::reset();
+
+		Request request;
+		while (instance.requests.pop(request)) {}
+		instance.droppedRequests.store(0, std::memory_order_relaxed);
+
+		instance.eventLoop.clear();
+		instance.teleopEventLoop.clear();
+
+#ifdef COMMAND_PROFILING
+		CommandProfiler::clear();
+#endif
 	}
 };
 
@@ -198,3 +914,21 @@ inline void Command::cancel() {
 inline bool Command::scheduled() const {
 	return CommandScheduler::scheduled(this);
 }
+
+inline const RequirementMask& Command::getRequirementMask() {
+	if (!requirementMaskCached) {
+		for (const auto requirement : getRequirements()) {
+			requirementMask.set(CommandScheduler::getSubsystemId(requirement));
+		}
+
+		requirementMaskCached = true;
+	}
+
+	return requirementMask;
+}
+
+inline void EventLoop::checkOwner() const {
+	// Bindings aren't queued, bind to the scheduler's event loops before it starts running or from its task
+	assert((this != CommandScheduler::getEventLoop() && this != CommandScheduler::getTeleopEventLoop()) ||
+		CommandScheduler::onSchedulerTask());
+}
@@ -1,6 +1,7 @@
 #pragma once
 
-#include "command/command.h"
+#include <algorithm>
+#include "command.h"
 
 /**
  * This class creates a conditional command that changes what runs based on a conditional input
@@ -8,7 +9,7 @@
 class ConditionalCommand : public Command {
 private:
 	Command* primary, *secondary, *selected{nullptr};
-	std::function<bool()> runPrimary;
+	InplaceFunction<bool()> runPrimary;
 public:
 	/**
 	 * @brief Create a new ConditionalCommand
@@ -17,10 +18,12 @@ public:
 	 * @param secondary The \refitem Command that is run when runPrimary is false on initialization
 	 * @param run_primary Conditional to determine which \refitem Command is run
 	 */
-	ConditionalCommand(Command *primary, Command *secondary, const std::function<bool()> &run_primary)
+	ConditionalCommand(Command *primary, Command *secondary, InplaceFunction<bool()> run_primary)
 		: primary(primary),
 		  secondary(secondary),
-		  runPrimary(run_primary) {
+		  runPrimary(std::move(run_primary)) {
+		hold(*this, *primary);
+		hold(*this, *secondary);
 	}
 
 	/**
@@ -32,7 +35,7 @@ public:
 		} else {
 			selected = secondary;
 		}
-		selected->initialize();
+		selected->begin();
 	}
 
 	/**
@@ -48,23 +51,29 @@ public:
 	 * @return selected->isFinished()
 	 */
 	bool isFinished() override {
-		return selected->isFinished();
+		return selected->done();
 	}
 
 	/**
 	 * Runs the selected function's end command
 	 */
 	void end(const bool interrupted) override {
-		selected->end(interrupted);
+		selected->finish(interrupted);
 	}
 
 	/**
-	 * @brief This class only captures the requirements of the running command
+	 * @brief Requires every \refitem Subsystem of both commands, as the selected command is only known once this is
+	 * initialized
 	 */
 	std::vector<Subsystem *> getRequirements() override {
-		if (runPrimary()) {
-			return primary->getRequirements();
+		std::vector<Subsystem *> requirements = primary->getRequirements();
+
+		for (auto subsystem : secondary->getRequirements()) {
+			if (std::ranges::find(requirements, subsystem) == requirements.end()) {
+				requirements.emplace_back(subsystem);
+			}
 		}
-		return secondary->getRequirements();
+
+		return requirements;
 	}
 };
\ No newline at end of file
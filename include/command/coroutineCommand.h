@@ -0,0 +1,400 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <initializer_list>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "command.h"
+#include "commandArena.h"
+#include "inplaceFunction.h"
+#include "schedulerClock.h"
+#include "units/units.hpp"
+
+/**
+ * @brief The number of coroutine frames the \refitem CoroutinePool holds, the most \refitem CoroutineCommand s that
+ * can run at once without falling back to the heap
+ */
+#ifndef COMMAND_COROUTINE_FRAMES
+#define COMMAND_COROUTINE_FRAMES 8
+#endif
+
+/**
+ * @brief The size in bytes of each frame in the \refitem CoroutinePool, routines with more local state than this
+ * fall back to the heap
+ */
+#ifndef COMMAND_COROUTINE_FRAME_SIZE
+#define COMMAND_COROUTINE_FRAME_SIZE 512
+#endif
+
+/**
+ * @brief Fixed set of equally sized blocks that the frames of \refitem Routine coroutines are allocated from
+ *
+ * @details Taking and returning a frame is a push or pop on a free list. Frames that are too large or don't fit in
+ * the pool are allocated with new instead and counted by getHeapFallbacks(). If that count isn't 0, raise
+ * COMMAND_COROUTINE_FRAMES or COMMAND_COROUTINE_FRAME_SIZE.
+ *
+ * @warning The pool isn't synchronized, only start and end routines from the scheduler task. A
+ * \refitem CoroutineCommand and the groups holding one stay on the scheduler task when a \refitem WorkerPool is set
+ */
+class CoroutinePool {
+private:
+	struct alignas(std::max_align_t) Frame {
+		union {
+			Frame *next;
+			std::byte storage[COMMAND_COROUTINE_FRAME_SIZE];
+		};
+	};
+
+	std::array<Frame, COMMAND_COROUTINE_FRAMES> frames;
+	Frame *free = nullptr;
+	size_t inUse = 0;
+	size_t heapFallbacks = 0;
+
+	CoroutinePool() {
+		for (auto &frame : frames) {
+			frame.next = free;
+			free = &frame;
+		}
+	}
+
+	static CoroutinePool &getInstance() {
+		static CoroutinePool instance;
+		return instance;
+	}
+
+	[[nodiscard]] bool owns(const void *pointer) const {
+		return pointer >= static_cast<const void *>(frames.data()) &&
+			pointer < static_cast<const void *>(frames.data() + frames.size());
+	}
+
+public:
+	CoroutinePool(const CoroutinePool &) = delete;
+
+	CoroutinePool &operator=(const CoroutinePool &) = delete;
+
+	/**
+	 * @brief Take a frame from the pool, or from the heap if the pool can't hold it
+	 *
+	 * @param size Size of the coroutine frame
+	 * @return Memory for the frame
+	 */
+	static void *allocate(const size_t size) {
+		CoroutinePool &instance = getInstance();
+
+		if (size > COMMAND_COROUTINE_FRAME_SIZE || instance.free == nullptr) {
+			instance.heapFallbacks++;
+
+			return ::operator new(size);
+		}
+
+		Frame *frame = instance.free;
+		instance.free = frame->next;
+		instance.inUse++;
+
+		return frame;
+	}
+
+	/**
+	 * @brief Return a frame taken with allocate()
+	 *
+	 * @param pointer The frame to return
+	 */
+	static void deallocate(void *pointer) {
+		CoroutinePool &instance = getInstance();
+
+		if (!instance.owns(pointer)) {
+			::operator delete(pointer);
+			return;
+		}
+
+		auto *frame = static_cast<Frame *>(pointer);
+		frame->next = instance.free;
+		instance.free = frame;
+		instance.inUse--;
+	}
+
+	/**
+	 * @return The number of frames taken from the pool
+	 */
+	static size_t getInUse() { return getInstance().inUse; }
+
+	/**
+	 * @return The number of frames that had to be allocated on the heap
+	 */
+	static size_t getHeapFallbacks() { return getInstance().heapFallbacks; }
+};
+
+/**
+ * @brief Coroutine type of the body of a \refitem CoroutineCommand
+ *
+ * @details Inside a Routine, co_await accepts a duration to wait for, a function returning bool to wait until it
+ * returns true, or a \refitem Command to run until it finishes. Each co_await suspends the routine until a later tick
+ * of the \refitem CoroutineCommand running it, and conditions that are already true don't suspend at all.
+ */
+class Routine {
+public:
+	enum class AwaitKind : std::uint8_t { None, Wait, Condition, Command };
+
+	struct promise_type {
+		AwaitKind kind = AwaitKind::None;
+
+		// The wait in progress, in the microseconds of SchedulerClock::now()
+		std::uint64_t waitStart = 0;
+		std::uint64_t waitDuration = 0;
+
+		InplaceFunction<bool()> condition;
+		Command *command = nullptr;
+
+		// The CoroutineCommand running the routine, set when it starts the routine
+		Command *owner = nullptr;
+
+		// Make sure an awaited command only requires subsystems the owner requires, only in debug builds
+		void checkRequirements(Command *awaited) const {
+#ifndef NDEBUG
+			if (owner != nullptr) {
+				assert((awaited->getRequirementMask() & ~owner->getRequirementMask()).none());
+			}
+#endif
+		}
+
+		static void *operator new(const size_t size) { return CoroutinePool::allocate(size); }
+
+		static void operator delete(void *pointer) { CoroutinePool::deallocate(pointer); }
+
+		Routine get_return_object() { return Routine(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+		// Runs from the first execute of the command, not when the routine is created
+		std::suspend_always initial_suspend() noexcept { return {}; }
+
+		// Stay suspended at the end so the command can see the routine is done
+		std::suspend_always final_suspend() noexcept { return {}; }
+
+		void return_void() {}
+
+		void unhandled_exception() { std::terminate(); }
+
+		struct Suspend {
+			bool ready;
+
+			[[nodiscard]] bool await_ready() const noexcept { return ready; }
+
+			void await_suspend(std::coroutine_handle<>) const noexcept {}
+
+			void await_resume() const noexcept {}
+		};
+
+		Suspend await_transform(const units::QTime duration) {
+			kind = AwaitKind::Wait;
+			waitStart = SchedulerClock::now();
+			waitDuration = SchedulerClock::toMicros(duration);
+
+			return {false};
+		}
+
+		template<typename F>
+			requires std::is_invocable_r_v<bool, F &>
+		Suspend await_transform(F &&function) {
+			if (function()) {
+				return {true};
+			}
+
+			kind = AwaitKind::Condition;
+			condition = std::forward<F>(function);
+
+			return {false};
+		}
+
+		Suspend await_transform(Command *awaited) {
+			checkRequirements(awaited);
+
+			kind = AwaitKind::Command;
+			command = awaited;
+
+			command->begin();
+
+			return {false};
+		}
+	};
+
+	Routine(Routine &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+	Routine &operator=(Routine &&other) noexcept {
+		if (this != &other) {
+			reset();
+			handle = std::exchange(other.handle, nullptr);
+		}
+
+		return *this;
+	}
+
+	Routine(const Routine &) = delete;
+
+	Routine &operator=(const Routine &) = delete;
+
+	/**
+	 * @brief Create an empty routine that is already done
+	 */
+	Routine() = default;
+
+	~Routine() { reset(); }
+
+	/**
+	 * @brief Destroy the coroutine frame, returning it to the \refitem CoroutinePool
+	 */
+	void reset() {
+		if (handle) {
+			handle.destroy();
+			handle = nullptr;
+		}
+	}
+
+	/**
+	 * @return true if the routine has returned, or is empty
+	 */
+	[[nodiscard]] bool done() const { return !handle || handle.done(); }
+
+	/**
+	 * @return The state of the routine, for \refitem CoroutineCommand
+	 */
+	[[nodiscard]] promise_type &promise() const { return handle.promise(); }
+
+	/**
+	 * @brief Run the routine until its next co_await or its end
+	 */
+	void resume() const {
+		promise().kind = AwaitKind::None;
+		handle.resume();
+	}
+
+private:
+	std::coroutine_handle<promise_type> handle = nullptr;
+
+	explicit Routine(const std::coroutine_handle<promise_type> handle) : handle(handle) {}
+};
+
+/**
+ * @brief \refitem Command whose body is a C++20 coroutine, so a routine can be written as straight-line code
+ *
+ * @details The body is started again every time the command is initialized, and resumed at most once per tick while
+ * the command runs. Commands awaited by the body are run inline by this command like in a \refitem Sequence, so they
+ * must only require subsystems this command requires, debug builds abort when one doesn't. When the command is
+ * interrupted, the awaited command is ended as interrupted and the body is destroyed without resuming it. Build the
+ * awaited commands once outside the body, a command created inside it is created again, and never freed, on every run.
+ *
+ * ```C
+ * Command *intakeIn = intake->pctCommand(1.0)->withTimeout(500_ms);
+ * Command *intakeOut = intake->pctCommand(-1.0)->withTimeout(300_ms);
+ *
+ * Command *autonomous = new CoroutineCommand([intakeIn, intakeOut]() -> Routine {
+ *     co_await intakeIn;
+ *     co_await 250_ms;
+ *     co_await []() { return limitSwitch.get_value(); };
+ *     co_await intakeOut;
+ * }, {intake});
+ * ```
+ *
+ * @warning The command keeps the body alive, so the captures of a lambda body stay valid while the routine runs. A
+ * separate function returning a Routine must take its arguments by value, references to them dangle once it returns
+ */
+class CoroutineCommand : public Command {
+private:
+	InplaceFunction<Routine()> body;
+	Routine routine;
+
+	std::pmr::vector<Subsystem *> requirements;
+
+	// Whether the routine can be resumed this tick, running the awaited command if there is one
+	bool ready() {
+		Routine::promise_type &promise = routine.promise();
+
+		switch (promise.kind) {
+			case Routine::AwaitKind::Wait:
+				return SchedulerClock::now() - promise.waitStart > promise.waitDuration;
+			case Routine::AwaitKind::Condition:
+				return promise.condition();
+			case Routine::AwaitKind::Command:
+				promise.command->execute();
+
+				if (promise.command->done()) {
+					promise.command->finish(false);
+					promise.command = nullptr;
+
+					return true;
+				}
+
+				return false;
+			case Routine::AwaitKind::None:
+			default:
+				return true;
+		}
+	}
+
+public:
+	/**
+	 * @brief Create a CoroutineCommand
+	 *
+	 * @param body Function returning the \refitem Routine to run, called every time the command is initialized
+	 * @param requirements Subsystems used by the routine and every command it awaits
+	 */
+	CoroutineCommand(InplaceFunction<Routine()> body, const std::initializer_list<Subsystem *> requirements)
+		: body(std::move(body)), requirements(requirements, CommandArena::getResource(this)) {
+		// The CoroutinePool and the requirement check of awaited commands are only safe on the scheduler task
+		runOnSchedulerTask(*this);
+	}
+
+	/**
+	 * @brief Start a new run of the body, replacing the previous one
+	 */
+	void initialize() override {
+		routine = body();
+
+		if (!routine.done()) {
+			routine.promise().owner = this;
+		}
+	}
+
+	/**
+	 * @brief Run the awaited command, and resume the body once what it awaits is done
+	 */
+	void execute() override {
+		if (!routine.done() && ready()) {
+			routine.resume();
+		}
+	}
+
+	/**
+	 * @return true once the body has returned
+	 */
+	bool isFinished() override {
+		return routine.done();
+	}
+
+	/**
+	 * @brief End the awaited command if the body is still waiting on one, and free the body
+	 *
+	 * @param interrupted Passed on to the awaited command
+	 */
+	void end(const bool interrupted) override {
+		if (!routine.done()) {
+			if (Routine::promise_type &promise = routine.promise(); promise.kind == Routine::AwaitKind::Command) {
+				promise.command->finish(interrupted);
+			}
+		}
+
+		routine.reset();
+	}
+
+	std::vector<Subsystem *> getRequirements() override {
+		return {requirements.begin(), requirements.end()};
+	}
+
+	~CoroutineCommand() override = default;
+};
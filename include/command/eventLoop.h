@@ -1,12 +1,446 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <unordered_map>
+#include <vector>
+#include "command.h"
+#include "commandArena.h"
+#include "executionProfile.h"
+#include "inplaceFunction.h"
+#include "schedulerClock.h"
+
+/**
+ * @brief Number of bytes a generic \refitem EventLoop binding can capture, the same on every target. Define this before
+ * including the library to raise it
+ */
+#ifndef COMMAND_BINDING_CAPACITY
+#define COMMAND_BINDING_CAPACITY (2 * COMMAND_FUNCTION_CAPACITY + 32)
+#endif
+
+/**
+ * @brief What a \refitem Trigger binding does with its command when its condition changes
+ */
+enum class TriggerMode : std::uint8_t {
+	/**
+	 * @brief Schedule on any change
+	 */
+	OnChange,
+	/**
+	 * @brief Schedule when the condition becomes true
+	 */
+	OnTrue,
+	/**
+	 * @brief Schedule when the condition becomes false
+	 */
+	OnFalse,
+	/**
+	 * @brief Schedule when the condition becomes true, cancel when it becomes false
+	 */
+	WhileTrue,
+	/**
+	 * @brief Schedule when the condition becomes false, cancel when it becomes true
+	 */
+	WhileFalse,
+	/**
+	 * @brief Schedule or cancel when the condition becomes true
+	 */
+	ToggleOnTrue,
+	/**
+	 * @brief Schedule or cancel when the condition becomes false
+	 */
+	ToggleOnFalse,
+};
+
+/**
+ * @brief The number of binding groups an \refitem EventLoop has, see EventLoop::setGroupEnabled
+ */
+constexpr std::uint8_t COMMAND_BINDING_GROUPS = 32;
+
+/**
+ * @brief Stable reference to a binding in an \refitem EventLoop
+ *
+ * @details The generation changes every time the binding's slot is freed, so a handle to a removed binding never
+ * refers to a later binding that reuses the slot
+ */
+struct BindingHandle {
+	std::uint32_t index = UINT32_MAX;
+	std::uint32_t generation = 0;
+
+	/**
+	 * True for bindings made with EventLoop::bind(Binding), false for \refitem Trigger bindings
+	 */
+	bool generic = false;
+};
+
 /**
  * @brief Event loops store user-defined bindings to be run every frame. This is used mostly to control the bindings
  * necessary for \refitem Trigger
+ *
+ * @details Trigger conditions form an expression DAG of leaf conditions combined with and, or, not, debounce and
+ * rising edge nodes. Children are always added before their parents, so one pass in index order evaluates every node
+ * exactly once per poll into a bitset. Identical nodes are found through a hash index and only stored once, so
+ * building an expression takes constant time per node. Trigger bindings are kept in flat arrays instead of closures,
+ * and are only walked on polls where a node changed.
+ *
+ * Nodes are reference counted. The add functions return a reference the caller gives back with release(), and every
+ * binding and parent node holds a reference to its node. A node without references is removed along with its
+ * condition, so unbinding the last binding of a \refitem Trigger that is no longer around stops its condition from
+ * being called, and its slot is reused by later nodes.
+ *
+ * Every binding lives in a slot map and bind() returns a \refitem BindingHandle to it, so single bindings can be
+ * unbound, suspended and resumed in constant time, and freed slots are reused without reallocating. Bindings also
+ * belong to one of COMMAND_BINDING_GROUPS groups that are enabled and disabled as a unit, to switch between driver
+ * profiles at runtime:
+ *
+ * ```C
+ * EventLoop *loop = CommandScheduler::getTeleopEventLoop();
+ *
+ * loop->setBindGroup(1);
+ * primary.getTrigger(DIGITAL_A)->onTrue(intakeCommand);
+ * loop->setBindGroup(2);
+ * primary.getTrigger(DIGITAL_A)->onTrue(shootCommand);
+ * loop->setBindGroup(0);
+ *
+ * // Start with the first profile
+ * loop->setGroupEnabled(2, false);
+ * ```
+ *
+ * @warning Changes to bindings and conditions aren't queued like CommandScheduler::schedule(), so the event loops of
+ * the \refitem CommandScheduler can only be changed before it starts running or from the scheduler task. Debug builds
+ * assert this
  */
 class EventLoop {
+public:
+	/**
+	 * @brief Type of a binding, an \refitem InplaceFunction so bindings never allocate
+	 */
+	using Binding = InplaceFunction<void(), COMMAND_BINDING_CAPACITY>;
+
+	/**
+	 * @brief Type of a \refitem Trigger condition
+	 */
+	using Condition = InplaceFunction<bool()>;
+
 private:
-	std::vector<std::function<void()>> bindings;
+	static constexpr size_t WORD_BITS = 64;
+
+	// Slot map entry of a binding, the generation changes whenever the slot is freed
+	struct Slot {
+		std::uint32_t generation = 0;
+		bool live = false;
+		bool suspended = false;
+		std::uint8_t group = 0;
+	};
+
+	// Generic bindings, run first every poll
+	std::vector<Binding> bindings;
+	std::vector<Slot> bindingSlots;
+	std::vector<std::uint32_t> freeBindingSlots;
+
+	enum class NodeKind : std::uint8_t { Leaf, And, Or, Not, Debounce, RisingEdge, Free };
+
+	// Node of the condition DAG, a and b are child node indices, or the condition index for a leaf
+	struct Node {
+		NodeKind kind;
+		std::uint32_t a;
+		std::uint32_t b;
+		// Debounce time in microseconds, and when the input started to differ from the output
+		std::uint32_t duration;
+		std::uint64_t since;
+	};
+
+	static constexpr std::uint64_t NOT_TIMING = UINT64_MAX;
+
+	// Identity of a combining node, leaves are never shared since their conditions can't be compared
+	struct NodeKey {
+		NodeKind kind;
+		std::uint32_t a;
+		std::uint32_t b;
+		std::uint32_t duration;
+
+		bool operator==(const NodeKey&) const = default;
+	};
+
+	struct NodeKeyHash {
+		size_t operator()(const NodeKey& key) const {
+			std::uint64_t hash = static_cast<std::uint64_t>(key.kind);
+			hash = hash * 0x9E3779B97F4A7C15ull ^ key.a;
+			hash = hash * 0x9E3779B97F4A7C15ull ^ key.b;
+			hash = hash * 0x9E3779B97F4A7C15ull ^ key.duration;
+
+			return static_cast<size_t>(hash ^ hash >> 32);
+		}
+	};
+
+	std::vector<Condition> conditions;
+	std::vector<Node> nodes;
+	size_t debounceNodes = 0;
+
+	// References to each node, kept apart from the nodes since poll never reads them
+	std::vector<std::uint32_t> references;
+
+	// Slots of removed nodes and conditions, reused by later ones
+	std::vector<std::uint32_t> freeNodes;
+	std::vector<std::uint32_t> freeConditions;
+
+	// Index of every combining node by its identity, so building an expression is constant time per node
+	std::unordered_map<NodeKey, std::uint32_t, NodeKeyHash> nodeIndex;
+
+	// Value of every node in the last poll and this poll as bitsets
+	std::vector<std::uint64_t> previous;
+	std::vector<std::uint64_t> current;
+
+	// Trigger bindings, entry i of each array describes binding i
+	std::vector<std::uint32_t> triggerConditions;
+	std::vector<TriggerMode> triggerModes;
+	std::vector<Command*> triggerCommands;
+	std::vector<Slot> triggerSlots;
+	std::vector<std::uint32_t> freeTriggerSlots;
+
+	// Value of each binding's node when the binding last saw it, a new binding starts from the node's value when bound
+	std::vector<std::uint8_t> triggerLast;
+
+	// Set when a new binding's starting value differs from its node's last poll, so the next poll walks the bindings
+	bool triggersDirty = false;
+
+	// Bit g is set while group g is enabled
+	std::uint32_t enabledGroups = UINT32_MAX;
+	std::uint8_t bindGroup = 0;
+
+	// Number of calls to clear()
+	std::uint32_t clears = 0;
+
+	[[nodiscard]] bool active(const Slot& slot) const {
+		return slot.live && !slot.suspended && (enabledGroups >> slot.group & 1) != 0;
+	}
+
+	// Takes a free slot or adds one at the end of slots, returning its index
+	std::uint32_t claimSlot(std::vector<Slot>& slots, std::vector<std::uint32_t>& free) {
+		std::uint32_t index;
+
+		if (free.empty()) {
+			index = static_cast<std::uint32_t>(slots.size());
+			slots.emplace_back();
+		} else {
+			index = free.back();
+			free.pop_back();
+		}
+
+		slots[index].live = true;
+		slots[index].suspended = false;
+		slots[index].group = bindGroup;
+
+		return index;
+	}
+
+	static void freeSlot(std::vector<Slot>& slots, std::vector<std::uint32_t>& free, const std::uint32_t index) {
+		slots[index].live = false;
+		slots[index].generation++;
+		free.push_back(index);
+	}
+
+	// The slot a handle refers to, nullptr if the binding was removed
+	Slot* find(const BindingHandle handle) {
+		std::vector<Slot>& slots = handle.generic ? bindingSlots : triggerSlots;
+
+		if (handle.index >= slots.size()) {
+			return nullptr;
+		}
+
+		Slot& slot = slots[handle.index];
+
+		return slot.live && slot.generation == handle.generation ? &slot : nullptr;
+	}
+
+	[[nodiscard]] static bool test(const std::vector<std::uint64_t>& bits, const size_t index) {
+		return (bits[index / WORD_BITS] >> (index % WORD_BITS) & 1) != 0;
+	}
+
+	static void assign(std::vector<std::uint64_t>& bits, const size_t index, const bool value) {
+		const std::uint64_t mask = std::uint64_t{1} << index % WORD_BITS;
+
+		bits[index / WORD_BITS] = value ? bits[index / WORD_BITS] | mask : bits[index / WORD_BITS] & ~mask;
+	}
+
+	// Value of a node from the values of its children, in bits, and its own state
+	bool evaluate(Node& node, const size_t index, const std::vector<std::uint64_t>& bits, const std::uint64_t now) {
+		switch (node.kind) {
+			case NodeKind::Leaf:
+				return conditions[node.a]();
+			case NodeKind::And:
+				return test(bits, node.a) && test(bits, node.b);
+			case NodeKind::Or:
+				return test(bits, node.a) || test(bits, node.b);
+			case NodeKind::Not:
+				return !test(bits, node.a);
+			case NodeKind::RisingEdge:
+				return test(bits, node.a) && !test(previous, node.a);
+			case NodeKind::Free:
+				return false;
+			case NodeKind::Debounce: {
+				const bool input = test(bits, node.a);
+				const bool output = test(previous, index);
+
+				if (input == output) {
+					node.since = NOT_TIMING;
+					return output;
+				}
+
+				if (node.since == NOT_TIMING) {
+					node.since = now;
+				}
+
+				if (now - node.since >= node.duration) {
+					node.since = NOT_TIMING;
+					return input;
+				}
+
+				return output;
+			}
+		}
+
+		return false;
+	}
+
+	// The value of a node right now, reading leaf conditions instead of their value from the last poll. Debounce
+	// nodes keep their output and rising edges are false, their values only change when polled
+	bool sample(const size_t index) {
+		const Node& node = nodes[index];
+
+		switch (node.kind) {
+			case NodeKind::Leaf:
+				return conditions[node.a]();
+			case NodeKind::And:
+				return sample(node.a) && sample(node.b);
+			case NodeKind::Or:
+				return sample(node.a) || sample(node.b);
+			case NodeKind::Not:
+				return !sample(node.a);
+			case NodeKind::Debounce:
+				return test(previous, index);
+			case NodeKind::RisingEdge:
+			case NodeKind::Free:
+			default:
+				return false;
+		}
+	}
+
+	// Asserts that the scheduler's event loops are only changed from the scheduler task, defined in commandScheduler.h
+	void checkOwner() const;
+
+	// Adds a node unless an identical one exists, seeding its previous value from its children. Either way the caller
+	// gets a reference to the node
+	size_t addNode(const NodeKind kind, const size_t a, const size_t b = 0, const std::uint32_t duration = 0) {
+		checkOwner();
+
+		const NodeKey key{kind, static_cast<std::uint32_t>(a), static_cast<std::uint32_t>(b), duration};
+
+		// Leaves always differ, their conditions can't be compared
+		if (kind != NodeKind::Leaf) {
+			if (const auto existing = nodeIndex.find(key); existing != nodeIndex.end()) {
+				references[existing->second]++;
+				return existing->second;
+			}
+
+			references[a]++;
+
+			if (kind == NodeKind::And || kind == NodeKind::Or) {
+				references[b]++;
+			}
+		}
+
+		// A reused slot has to come after the node's children, so one pass in index order still sees them first
+		size_t index = nodes.size();
+
+		if (!freeNodes.empty() && (kind == NodeKind::Leaf || freeNodes.back() > std::max(a, b))) {
+			index = freeNodes.back();
+			freeNodes.pop_back();
+
+			nodes[index] = {kind, key.a, key.b, duration, NOT_TIMING};
+			references[index] = 1;
+		} else {
+			if (index % WORD_BITS == 0) {
+				previous.push_back(0);
+				current.push_back(0);
+			}
+
+			nodes.push_back({kind, key.a, key.b, duration, NOT_TIMING});
+			references.push_back(1);
+		}
+
+		if (kind != NodeKind::Leaf) {
+			nodeIndex.emplace(key, static_cast<std::uint32_t>(index));
+		}
+
+		if (kind == NodeKind::Debounce) {
+			// Start out agreeing with the input
+			assign(previous, index, test(previous, a));
+			debounceNodes++;
+		} else if (kind == NodeKind::RisingEdge) {
+			assign(previous, index, false);
+		} else {
+			assign(previous, index, evaluate(nodes[index], index, previous, 0));
+		}
+
+		return index;
+	}
+
+	static void toggle(Command* command) {
+		if (command->scheduled()) {
+			command->cancel();
+		} else {
+			command->schedule();
+		}
+	}
+
+	static void dispatch(const TriggerMode mode, Command* command, const bool value) {
+		switch (mode) {
+			case TriggerMode::OnChange:
+				command->schedule();
+				break;
+			case TriggerMode::OnTrue:
+			case TriggerMode::OnFalse:
+				if (value == (mode == TriggerMode::OnTrue)) {
+					command->schedule();
+				}
+				break;
+			case TriggerMode::WhileTrue:
+			case TriggerMode::WhileFalse:
+				if (value == (mode == TriggerMode::WhileTrue)) {
+					command->schedule();
+				} else {
+					command->cancel();
+				}
+				break;
+			case TriggerMode::ToggleOnTrue:
+			case TriggerMode::ToggleOnFalse:
+				if (value == (mode == TriggerMode::ToggleOnTrue)) {
+					toggle(command);
+				}
+				break;
+		}
+	}
+
+	// Time spent in poll, empty unless COMMAND_PROFILING is defined
+	[[no_unique_address]] ExecutionProfile profile;
+
+	// Placed in the arena of the CommandArena::Scope a trigger binding was made in, so resetting the arena removes
+	// the binding before destroying the commands it schedules
+	struct ArenaBinding {
+		EventLoop* loop;
+		BindingHandle handle;
+
+		ArenaBinding(EventLoop* loop, const BindingHandle handle) : loop(loop), handle(handle) {}
+
+		ArenaBinding(const ArenaBinding&) = delete;
+
+		ArenaBinding& operator=(const ArenaBinding&) = delete;
+
+		~ArenaBinding() { loop->unbind(handle); }
+	};
 public:
 	/**
 	 * Initialize a new empty EventLoop with no bindings
@@ -18,37 +452,408 @@ public:
 	 *
 	 * @param bindings Vector storing the bindings to initialize the EventLoop
 	 */
-	explicit EventLoop(std::vector<std::function<void()>> bindings) : bindings(std::move(bindings)) {}
+	explicit EventLoop(std::vector<Binding> bindings) : bindings(std::move(bindings)) {
+		bindingSlots.resize(this->bindings.size(), Slot{0, true, false, 0});
+	}
 
 	/**
 	 * @brief Initialize the EventLoop with a initializer list of bindings
 	 *
 	 * @param bindings Initializer list for new bindings
 	 */
-	EventLoop(const std::initializer_list<std::function<void()>> bindings) : bindings(bindings) {}
+	EventLoop(const std::initializer_list<Binding> bindings) : bindings(bindings) {
+		bindingSlots.resize(this->bindings.size(), Slot{0, true, false, 0});
+	}
 
 	/**
 	 * @brief Poll is run every frame and runs each of the bindings. This is generally run by the CommandScheduler
 	 */
 	void poll() {
-		for (const auto& binding: this->bindings) {
-			binding();
+		ProfileTimer timer(profile);
+
+		for (size_t i = 0; i < bindings.size(); i++) {
+			if (active(bindingSlots[i])) {
+				bindings[i]();
+			}
 		}
+
+		const std::uint64_t now = debounceNodes > 0 ? SchedulerClock::now() : 0;
+
+		// Children come before their parents, so their bits are already set when a parent reads them
+		for (size_t i = 0; i < nodes.size(); i++) {
+			assign(current, i, evaluate(nodes[i], i, current, now));
+		}
+
+		if (!triggersDirty && std::equal(current.begin(), current.end(), previous.begin())) {
+			return;
+		}
+
+		triggersDirty = false;
+
+		// Inactive bindings still take the new value, so they miss the change instead of seeing it once resumed
+		for (size_t i = 0; i < triggerCommands.size(); i++) {
+			const bool value = test(current, triggerConditions[i]);
+
+			if (value != (triggerLast[i] != 0) && triggerSlots[i].live) {
+				triggerLast[i] = value;
+
+				if (active(triggerSlots[i])) {
+					dispatch(triggerModes[i], triggerCommands[i], value);
+				}
+			}
+		}
+
+		std::copy(current.begin(), current.end(), previous.begin());
 	}
 
 	/**
 	 * @brief Bind a new command to the EventLoop
 	 * @param binding The void function binding to run every frame
+	 * @return Handle to the binding, in the group set by setBindGroup
 	 */
-	void bind(const std::function<void()>& binding) {
-		bindings.emplace_back(binding);
+	BindingHandle bind(Binding binding) {
+		checkOwner();
+
+		const std::uint32_t index = claimSlot(bindingSlots, freeBindingSlots);
+
+		if (index == bindings.size()) {
+			bindings.emplace_back(std::move(binding));
+		} else {
+			bindings[index] = std::move(binding);
+		}
+
+		return {index, bindingSlots[index].generation, true};
+	}
+
+	/**
+	 * @brief Add a leaf condition to the DAG, it is evaluated once every poll
+	 *
+	 * @param condition The condition, evaluated once now for its starting value
+	 * @return Index of the node, used to build other nodes and with bind(size_t, TriggerMode, Command*). The caller
+	 * holds a reference to it, like with the other add functions
+	 */
+	size_t addCondition(Condition condition) {
+		checkOwner();
+
+		if (freeConditions.empty()) {
+			conditions.emplace_back(std::move(condition));
+
+			return addNode(NodeKind::Leaf, conditions.size() - 1);
+		}
+
+		const std::uint32_t slot = freeConditions.back();
+		freeConditions.pop_back();
+		conditions[slot] = std::move(condition);
+
+		return addNode(NodeKind::Leaf, slot);
+	}
+
+	/**
+	 * @return Index of a node that is true when both nodes are true
+	 */
+	size_t addAnd(const size_t a, const size_t b) {
+		return addNode(NodeKind::And, std::min(a, b), std::max(a, b));
+	}
+
+	/**
+	 * @return Index of a node that is true when either node is true
+	 */
+	size_t addOr(const size_t a, const size_t b) {
+		return addNode(NodeKind::Or, std::min(a, b), std::max(a, b));
+	}
+
+	/**
+	 * @return Index of a node that is true when the node is false
+	 */
+	size_t addNot(const size_t a) {
+		return addNode(NodeKind::Not, a);
+	}
+
+	/**
+	 * @brief Add a node that only follows a node once it has held a new value for a time
+	 *
+	 * @param a The node to debounce
+	 * @param microseconds How long the node has to keep a new value before this node changes to it
+	 * @return Index of the debounced node
+	 */
+	size_t addDebounce(const size_t a, const std::uint32_t microseconds) {
+		return addNode(NodeKind::Debounce, a, 0, microseconds);
+	}
+
+	/**
+	 * @return Index of a node that is true only on the poll where the node changes from false to true
+	 */
+	size_t addRisingEdge(const size_t a) {
+		return addNode(NodeKind::RisingEdge, a);
+	}
+
+	/**
+	 * @brief Take another reference to a node, it stays in the DAG until every reference is released
+	 *
+	 * @param node Index of a node with at least one reference
+	 */
+	void retain(const size_t node) {
+		checkOwner();
+
+		// Make sure the node hasn't been removed
+		assert(references[node] > 0);
+
+		references[node]++;
+	}
+
+	/**
+	 * @brief Give back a reference to a node. The last reference removes the node and destroys its condition, and
+	 * releases the node's children
+	 *
+	 * @param node Index of a node the caller holds a reference to
+	 */
+	void release(const size_t node) {
+		checkOwner();
+
+		// Make sure the node hasn't been removed
+		assert(references[node] > 0);
+
+		if (--references[node] > 0) {
+			return;
+		}
+
+		const Node removed = nodes[node];
+
+		nodes[node].kind = NodeKind::Free;
+		freeNodes.push_back(static_cast<std::uint32_t>(node));
+
+		switch (removed.kind) {
+			case NodeKind::Leaf:
+				// Release anything the condition captured
+				conditions[removed.a].reset();
+				freeConditions.push_back(removed.a);
+				return;
+			case NodeKind::And:
+			case NodeKind::Or:
+				release(removed.b);
+				break;
+			case NodeKind::Debounce:
+				debounceNodes--;
+				break;
+			case NodeKind::Not:
+			case NodeKind::RisingEdge:
+			case NodeKind::Free:
+				break;
+		}
+
+		nodeIndex.erase({removed.kind, removed.a, removed.b, removed.duration});
+		release(removed.a);
+	}
+
+	/**
+	 * @return Number of nodes in the DAG, all of them are evaluated every poll
+	 */
+	[[nodiscard]] size_t getNodeCount() const { return nodes.size() - freeNodes.size(); }
+
+	/**
+	 * @brief Bind a command to changes of a condition
+	 *
+	 * @details The binding starts from the value of the condition when it is bound, read from its leaf conditions
+	 * right away, and only acts on changes after that. So a condition that is already true doesn't fire an OnTrue
+	 * binding until it goes false and true again.
+	 *
+	 * A binding made while a CommandArena::Scope is alive belongs to that arena, and is removed when the arena is
+	 * reset, before its commands are destroyed. The event loop has to outlive the arena
+	 *
+	 * @param condition Index of a node returned by addCondition or one of the other add functions
+	 * @param mode What to do with the command when the condition changes
+	 * @param command The command to schedule or cancel
+	 * @return Handle to the binding, in the group set by setBindGroup
+	 */
+	BindingHandle bind(const size_t condition, const TriggerMode mode, Command* command) {
+		checkOwner();
+
+		// The binding keeps its node in the DAG until it is removed
+		retain(condition);
+
+		const std::uint32_t index = claimSlot(triggerSlots, freeTriggerSlots);
+
+		const bool value = sample(condition);
+
+		if (index == triggerCommands.size()) {
+			triggerConditions.push_back(static_cast<std::uint32_t>(condition));
+			triggerModes.push_back(mode);
+			triggerCommands.push_back(command);
+			triggerLast.push_back(value);
+		} else {
+			triggerConditions[index] = static_cast<std::uint32_t>(condition);
+			triggerModes[index] = mode;
+			triggerCommands[index] = command;
+			triggerLast[index] = value;
+		}
+
+		// The next poll compares against this value instead of the node's value in the last poll
+		triggersDirty = triggersDirty || value != test(previous, condition);
+
+		const BindingHandle handle{index, triggerSlots[index].generation, false};
+
+		if (CommandArena* arena = CommandArena::getCurrent(); arena != nullptr) {
+			arena->create<ArenaBinding>(this, handle);
+		}
+
+		return handle;
+	}
+
+	/**
+	 * @brief Remove a binding, its slot is reused by later bindings
+	 *
+	 * @param handle Handle returned by bind
+	 * @return false if the binding was already removed
+	 */
+	bool unbind(const BindingHandle handle) {
+		checkOwner();
+
+		if (find(handle) == nullptr) {
+			return false;
+		}
+
+		if (handle.generic) {
+			// Release anything the binding captured
+			bindings[handle.index].reset();
+			freeSlot(bindingSlots, freeBindingSlots, handle.index);
+		} else {
+			freeSlot(triggerSlots, freeTriggerSlots, handle.index);
+			release(triggerConditions[handle.index]);
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief Stop running a binding until it is resumed. A suspended \refitem Trigger binding misses the changes of
+	 * its condition, and leaves its command scheduled
+	 *
+	 * @param handle Handle returned by bind
+	 * @return false if the binding was removed
+	 */
+	bool suspend(const BindingHandle handle) {
+		checkOwner();
+
+		Slot* slot = find(handle);
+
+		if (slot != nullptr) {
+			slot->suspended = true;
+		}
+
+		return slot != nullptr;
+	}
+
+	/**
+	 * @brief Run a suspended binding again
+	 *
+	 * @param handle Handle returned by bind
+	 * @return false if the binding was removed
+	 */
+	bool resume(const BindingHandle handle) {
+		checkOwner();
+
+		Slot* slot = find(handle);
+
+		if (slot != nullptr) {
+			slot->suspended = false;
+		}
+
+		return slot != nullptr;
+	}
+
+	/**
+	 * @param handle Handle returned by bind
+	 * @return true if the binding hasn't been removed
+	 */
+	[[nodiscard]] bool isBound(const BindingHandle handle) {
+		return find(handle) != nullptr;
+	}
+
+	/**
+	 * @brief Set the group of the bindings made after this call, 0 by default
+	 *
+	 * @param group Group from 0 to COMMAND_BINDING_GROUPS - 1
+	 */
+	void setBindGroup(const std::uint8_t group) {
+		checkOwner();
+
+		// Make sure the group exists
+		assert(group < COMMAND_BINDING_GROUPS);
+
+		bindGroup = group;
+	}
+
+	/**
+	 * @brief Enable or disable every binding in a group at once, all groups start enabled. Disabled
+	 * \refitem Trigger bindings miss the changes of their conditions, and leave their commands scheduled
+	 *
+	 * @param group Group from 0 to COMMAND_BINDING_GROUPS - 1
+	 * @param enabled Whether the group's bindings run
+	 */
+	void setGroupEnabled(const std::uint8_t group, const bool enabled) {
+		checkOwner();
+
+		// Make sure the group exists
+		assert(group < COMMAND_BINDING_GROUPS);
+
+		enabledGroups = enabled ? enabledGroups | 1u << group : enabledGroups & ~(1u << group);
+	}
+
+	/**
+	 * @param group Group from 0 to COMMAND_BINDING_GROUPS - 1
+	 * @return Whether the group's bindings run
+	 */
+	[[nodiscard]] bool isGroupEnabled(const std::uint8_t group) const {
+		return (enabledGroups >> group & 1) != 0;
 	}
 
 	/**
-	 * @brief Clear all bindings on this event loop
+	 * @brief Get the timing statistics of poll, only recorded when COMMAND_PROFILING is defined
+	 *
+	 * @return Time spent in each poll
+	 */
+	[[nodiscard]] const ExecutionProfile &getProfile() const { return profile; }
+
+	/**
+	 * @return Number of times clear() was called, to tell when conditions added before a call were removed
+	 */
+	[[nodiscard]] std::uint32_t getClearCount() const { return clears; }
+
+	/**
+	 * @brief Clear all bindings and conditions on this event loop, enable every group and go back to group 0
+	 *
+	 * @details The slots are kept for reuse, so handles to the cleared bindings stay invalid
 	 */
 	void clear() {
-		bindings.clear();
+		checkOwner();
+
+		for (std::uint32_t i = 0; i < bindingSlots.size(); i++) {
+			if (bindingSlots[i].live) {
+				bindings[i].reset();
+				freeSlot(bindingSlots, freeBindingSlots, i);
+			}
+		}
+
+		for (std::uint32_t i = 0; i < triggerSlots.size(); i++) {
+			if (triggerSlots[i].live) {
+				freeSlot(triggerSlots, freeTriggerSlots, i);
+			}
+		}
+
+		conditions.clear();
+		nodes.clear();
+		nodeIndex.clear();
+		references.clear();
+		freeNodes.clear();
+		freeConditions.clear();
+		debounceNodes = 0;
+		previous.clear();
+		current.clear();
+		triggersDirty = false;
+
+		enabledGroups = UINT32_MAX;
+		bindGroup = 0;
+		clears++;
 	}
 
 	~EventLoop() = default;
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include "api.h"
+
+/**
+ * Define COMMAND_PROFILING before including the library to time every Subsystem::periodic(), EventLoop::poll() and
+ * Command update in CommandScheduler::run(). When it isn't defined the profiles are empty and the timers do nothing,
+ * so profiling costs nothing at runtime or in memory.
+ */
+
+/**
+ * @brief Function returning the current time in microseconds used for profiling. Define this before including the
+ * library to profile against a different clock, such as the wall clock when using a simulated pros::micros()
+ */
+#ifndef COMMAND_PROFILER_CLOCK
+#define COMMAND_PROFILER_CLOCK pros::micros
+#endif
+
+/**
+ * @brief Part of a command update that is timed on its own, see Command::getPhaseProfile()
+ */
+enum class ProfilePhase : std::uint8_t {
+	Execute,
+	IsFinished,
+	End,
+};
+
+#ifdef COMMAND_PROFILING
+
+/**
+ * @brief Fixed-size timing statistics for one piece of scheduled work
+ *
+ * @details Samples are kept as a count, sum, min and max, plus a histogram with power of two microsecond buckets
+ * used to estimate percentiles. Recording a sample never allocates.
+ */
+class ExecutionProfile {
+private:
+	friend class CommandProfiler;
+
+	static constexpr size_t BUCKETS = 32;
+
+	// Set once the owning command is in the CommandProfiler list
+	bool tracked = false;
+
+	// Bucket i holds samples with a bit width of i, [2^(i-1), 2^i) microseconds
+	std::array<std::uint32_t, BUCKETS> histogram{};
+	std::uint32_t count = 0;
+	std::uint64_t total = 0;
+	std::uint32_t min = UINT32_MAX;
+	std::uint32_t max = 0;
+
+public:
+	/**
+	 * @brief Add a sample
+	 *
+	 * @param micros The duration in microseconds
+	 */
+	void record(const std::uint64_t micros) {
+		const auto sample = static_cast<std::uint32_t>(micros < UINT32_MAX ? micros : UINT32_MAX);
+
+		histogram[std::min<size_t>(std::bit_width(sample), BUCKETS - 1)]++;
+		count++;
+		total += sample;
+		min = std::min(min, sample);
+		max = std::max(max, sample);
+	}
+
+	/**
+	 * @brief Clear all samples
+	 */
+	void reset() {
+		const bool wasTracked = tracked;
+		*this = ExecutionProfile{};
+		tracked = wasTracked;
+	}
+
+	[[nodiscard]] std::uint32_t getCount() const { return count; }
+
+	[[nodiscard]] std::uint64_t getTotal() const { return total; }
+
+	[[nodiscard]] std::uint32_t getMin() const { return count == 0 ? 0 : min; }
+
+	[[nodiscard]] std::uint32_t getMax() const { return max; }
+
+	[[nodiscard]] double getMean() const { return count == 0 ? 0.0 : static_cast<double>(total) / count; }
+
+	/**
+	 * @brief Estimate a percentile from the histogram
+	 *
+	 * @param percentile The percentile in the range [0, 1], 0.99 for p99
+	 * @return Upper bound of the histogram bucket holding the percentile in microseconds, at most the max sample
+	 */
+	[[nodiscard]] std::uint32_t getPercentile(const double percentile) const {
+		const auto target = static_cast<std::uint64_t>(percentile * count + 0.5);
+		std::uint64_t seen = 0;
+
+		for (size_t i = 0; i < BUCKETS; i++) {
+			seen += histogram[i];
+
+			if (seen >= target && seen > 0) {
+				const std::uint32_t upper = i == 0 ? 0 : static_cast<std::uint32_t>((std::uint64_t{1} << i) - 1);
+				return std::min(upper, max);
+			}
+		}
+
+		return max;
+	}
+
+	[[nodiscard]] std::uint32_t getP99() const { return getPercentile(0.99); }
+};
+
+/**
+ * @brief Records the time from construction to destruction into an \refitem ExecutionProfile
+ */
+class ProfileTimer {
+private:
+	ExecutionProfile &profile;
+	std::uint64_t start;
+
+public:
+	explicit ProfileTimer(ExecutionProfile &profile) : profile(profile), start(COMMAND_PROFILER_CLOCK()) {}
+
+	ProfileTimer(const ProfileTimer &) = delete;
+
+	~ProfileTimer() { profile.record(COMMAND_PROFILER_CLOCK() - start); }
+};
+
+/**
+ * @brief One \refitem ExecutionProfile for each \refitem ProfilePhase of a command
+ */
+class PhaseProfiles {
+private:
+	std::array<ExecutionProfile, 3> profiles{};
+
+public:
+	ExecutionProfile &operator[](const ProfilePhase phase) { return profiles[static_cast<size_t>(phase)]; }
+
+	const ExecutionProfile &operator[](const ProfilePhase phase) const { return profiles[static_cast<size_t>(phase)]; }
+
+	/**
+	 * @brief Clear the samples of every phase
+	 */
+	void reset() {
+		for (auto &profile : profiles) {
+			profile.reset();
+		}
+	}
+};
+
+#else
+
+class ExecutionProfile {
+public:
+	void reset() {}
+};
+
+class ProfileTimer {
+public:
+	explicit ProfileTimer(ExecutionProfile &) {}
+};
+
+class PhaseProfiles {
+private:
+	static inline ExecutionProfile empty;
+
+public:
+	ExecutionProfile &operator[](ProfilePhase) const { return empty; }
+
+	void reset() {}
+};
+
+#endif
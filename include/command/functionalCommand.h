@@ -1,38 +1,55 @@
 #pragma once
 
+#include <initializer_list>
+#include <memory_resource>
+#include <vector>
 #include "command.h"
+#include "commandArena.h"
+#include "inplaceFunction.h"
 
+/**
+ * @brief \refitem Command built from user-defined functions for each stage of the command
+ *
+ * @details The functions are stored in \refitem InplaceFunction s, so creating a FunctionalCommand never allocates
+ * for its callbacks. Any of the functions can be left empty ({} or nullptr), in which case that stage does nothing.
+ * An empty is_finish never finishes.
+ */
 class FunctionalCommand : public Command {
 private:
 
-	std::function<void()> onInit;
-	std::function<void()> onExecute;
-	std::function<void(bool)> onEnd;
-	std::function<bool()> isFinish;
+	InplaceFunction<void()> onInit;
+	InplaceFunction<void()> onExecute;
+	InplaceFunction<void(bool)> onEnd;
+	InplaceFunction<bool()> isFinish;
 
-	std::vector<Subsystem*> requirements;
+	std::pmr::vector<Subsystem*> requirements;
 public:
-	FunctionalCommand(std::function<void()> on_init, std::function<void()> on_execute, std::function<void(bool)> on_end,
-		std::function<bool()> is_finish, const std::initializer_list<Subsystem*> requirements)
+	FunctionalCommand(InplaceFunction<void()> on_init, InplaceFunction<void()> on_execute,
+		InplaceFunction<void(bool)> on_end, InplaceFunction<bool()> is_finish,
+		const std::initializer_list<Subsystem*> requirements)
 		: onInit(std::move(on_init)),
 		  onExecute(std::move(on_execute)),
 		  onEnd(std::move(on_end)),
 		  isFinish(std::move(is_finish)),
-		  requirements(requirements) {
+		  requirements(requirements, CommandArena::getResource(this)) {
 	}
 
 	/**
 	 * @brief Runs the user-defined initializer function
 	 */
 	void initialize() override {
-		onInit();
+		if (onInit) {
+			onInit();
+		}
 	}
 
 	/**
 	 * @brief Runs the user-defined execute function
 	 */
 	void execute() override {
-		onExecute();
+		if (onExecute) {
+			onExecute();
+		}
 	}
 
 	/**
@@ -41,7 +58,7 @@ public:
 	 * @return The boolean result from the user defined function
 	 */
 	bool isFinished() override {
-		return isFinish();
+		return isFinish && isFinish();
 	}
 
 	/**
@@ -50,7 +67,9 @@ public:
 	 * @param interrupted Passes on the interrupted parameter to the user-defined function
 	 */
 	void end(const bool interrupted) override {
-		onEnd(interrupted);
+		if (onEnd) {
+			onEnd(interrupted);
+		}
 	}
 
 	/**
@@ -59,7 +78,7 @@ public:
 	 * @return User-defined requirements for the subsystem
 	 */
 	std::vector<Subsystem *> getRequirements() override {
-		return requirements;
+		return {requirements.begin(), requirements.end()};
 	}
 
 	/**
@@ -1,20 +1,34 @@
 #pragma once
 
 #include "command.h"
+#include "commandArena.h"
 #include "commandController.h"
+#include "commandProfiler.h"
 #include "commandScheduler.h"
 #include "conditionalCommand.h"
+#include "coroutineCommand.h"
 #include "eventLoop.h"
+#include "executionProfile.h"
 #include "functionalCommand.h"
+#include "inplaceFunction.h"
 #include "instantCommand.h"
+#include "mpscQueue.h"
 #include "parallelCommandGroup.h"
 #include "parallelRaceGroup.h"
 #include "proxyCommand.h"
 #include "repeatCommand.h"
+#include "requirementMask.h"
 #include "runCommand.h"
+#include "schedulerClock.h"
+#include "schedulerRunner.h"
 #include "scheduleCommand.h"
+#include "seqLock.h"
 #include "sequence.h"
+#include "staticParallel.h"
+#include "staticRace.h"
+#include "staticSequence.h"
 #include "subsystem.h"
 #include "trigger.h"
 #include "waitCommand.h"
-#include "waitUntilCommand.h"
\ No newline at end of file
+#include "waitUntilCommand.h"
+#include "workerPool.h"
\ No newline at end of file
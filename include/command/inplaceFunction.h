@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Default number of bytes a \refitem InplaceFunction can store its callable in. Enough for a lambda capturing
+ * `this` and a few doubles. It is the same on every target, so a callable that fits in the host build also fits on the
+ * V5. Define this before including the library to raise it
+ */
+#ifndef COMMAND_FUNCTION_CAPACITY
+#define COMMAND_FUNCTION_CAPACITY 32
+#endif
+
+template<typename Signature, size_t Capacity = COMMAND_FUNCTION_CAPACITY>
+class InplaceFunction;
+
+/**
+ * @brief A std::function replacement that stores its callable in a fixed inline buffer and never allocates
+ *
+ * @details The callable is stored inside the InplaceFunction, so constructing, copying and calling one never touches
+ * the heap. Callables that don't fit in Capacity bytes fail to compile instead of falling back to the heap. Calling
+ * goes through a single function pointer, and callables that are trivially copyable (lambdas capturing pointers and
+ * numbers) need no extra bookkeeping to copy or destroy.
+ *
+ * ```C
+ * InplaceFunction<void()> function = [this, pct]() { this->setPct(pct); };
+ *
+ * if (function) {
+ *     function();
+ * }
+ * ```
+ *
+ * @tparam R Return type of the function
+ * @tparam Args Argument types of the function
+ * @tparam Capacity Size of the inline buffer in bytes
+ */
+template<typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+private:
+	enum class Operation { Copy, Move, Destroy };
+
+	using Invoker = R (*)(void *, Args...);
+	using Manager = void (*)(void *destination, void *source, Operation operation);
+
+	// Zeroed so trivially copyable callables can be copied as a whole buffer without reading uninitialized bytes
+	alignas(std::max_align_t) mutable std::byte storage[Capacity]{};
+	Invoker invoker = nullptr;
+	// nullptr for trivially copyable callables, which are copied with memcpy and need no destruction
+	Manager manager = nullptr;
+
+	template<typename T>
+	static R invoke(void *callable, Args... args) {
+		return std::invoke(*static_cast<T *>(callable), std::forward<Args>(args)...);
+	}
+
+	template<typename T>
+	static void manage(void *destination, void *source, const Operation operation) {
+		switch (operation) {
+			case Operation::Copy:
+				::new (destination) T(*static_cast<const T *>(source));
+				break;
+			case Operation::Move:
+				::new (destination) T(std::move(*static_cast<T *>(source)));
+				break;
+			case Operation::Destroy:
+				static_cast<T *>(destination)->~T();
+				break;
+		}
+	}
+
+	void copyFrom(const InplaceFunction &other) {
+		invoker = other.invoker;
+		manager = other.manager;
+
+		if (manager != nullptr) {
+			manager(storage, other.storage, Operation::Copy);
+		} else if (invoker != nullptr) {
+			std::memcpy(storage, other.storage, Capacity);
+		}
+	}
+
+	void moveFrom(InplaceFunction &other) {
+		invoker = other.invoker;
+		manager = other.manager;
+
+		if (manager != nullptr) {
+			manager(storage, other.storage, Operation::Move);
+		} else if (invoker != nullptr) {
+			std::memcpy(storage, other.storage, Capacity);
+		}
+	}
+
+public:
+	/**
+	 * @brief Create an empty InplaceFunction
+	 */
+	InplaceFunction() = default;
+
+	/**
+	 * @brief Create an empty InplaceFunction
+	 */
+	InplaceFunction(std::nullptr_t) {}
+
+	/**
+	 * @brief Store a callable in this InplaceFunction
+	 *
+	 * @param callable Lambda, function pointer or function object to store, it must fit in Capacity bytes
+	 */
+	template<typename F, typename T = std::decay_t<F>>
+		requires(!std::is_same_v<T, InplaceFunction> && std::is_invocable_r_v<R, T &, Args...>)
+	InplaceFunction(F &&callable) {
+		static_assert(sizeof(T) <= Capacity, "Callable is too large for InplaceFunction, raise its capacity");
+		static_assert(alignof(T) <= alignof(std::max_align_t), "Callable is over-aligned for InplaceFunction");
+
+		if constexpr (std::is_pointer_v<T> || std::is_member_pointer_v<T>) {
+			if (callable == nullptr) {
+				return;
+			}
+		}
+
+		::new (static_cast<void *>(storage)) T(std::forward<F>(callable));
+		invoker = &invoke<T>;
+
+		if constexpr (!std::is_trivially_copyable_v<T> || !std::is_trivially_destructible_v<T>) {
+			manager = &manage<T>;
+		}
+	}
+
+	InplaceFunction(const InplaceFunction &other) { copyFrom(other); }
+
+	InplaceFunction(InplaceFunction &&other) noexcept { moveFrom(other); }
+
+	InplaceFunction &operator=(const InplaceFunction &other) {
+		if (this != &other) {
+			reset();
+			copyFrom(other);
+		}
+		return *this;
+	}
+
+	InplaceFunction &operator=(InplaceFunction &&other) noexcept {
+		if (this != &other) {
+			reset();
+			moveFrom(other);
+		}
+		return *this;
+	}
+
+	InplaceFunction &operator=(std::nullptr_t) {
+		reset();
+		return *this;
+	}
+
+	/**
+	 * @brief Destroy the stored callable, leaving this InplaceFunction empty
+	 */
+	void reset() {
+		if (manager != nullptr) {
+			manager(storage, nullptr, Operation::Destroy);
+		}
+
+		invoker = nullptr;
+		manager = nullptr;
+	}
+
+	/**
+	 * @brief Call the stored callable
+	 *
+	 * @warning The InplaceFunction must not be empty
+	 */
+	R operator()(Args... args) const { return invoker(storage, std::forward<Args>(args)...); }
+
+	/**
+	 * @brief Check if a callable is stored
+	 *
+	 * @return True if this InplaceFunction can be called
+	 */
+	explicit operator bool() const { return invoker != nullptr; }
+
+	~InplaceFunction() { reset(); }
+};
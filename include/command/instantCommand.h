@@ -13,8 +13,8 @@ public:
 	 * @param on_init Function to run once upon function start
 	 * @param requirements Subsystem requirements for this command
 	 */
-	InstantCommand(const std::function<void()> &on_init, const std::initializer_list<Subsystem *> &requirements)
-		: FunctionalCommand(on_init, [] {}, [](bool _) {}, [] { return true; } , requirements) {
+	InstantCommand(InplaceFunction<void()> on_init, const std::initializer_list<Subsystem *> &requirements)
+		: FunctionalCommand(std::move(on_init), {}, {}, [] { return true; }, requirements) {
 	}
 
 	~InstantCommand() override = default;
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Bounded lock-free queue that any number of tasks can push to and one task pops from
+ *
+ * @details Each cell carries a sequence number that tells producers whether it is free and the consumer whether it is
+ * filled, so a push is one compare and swap on the shared position and a pop touches no shared position at all.
+ * Neither operation blocks or allocates.
+ *
+ * @tparam T Type of the elements, copied in and out of the queue
+ * @tparam Capacity Maximum number of queued elements, a power of two
+ */
+template<typename T, size_t Capacity>
+class MpscQueue {
+	static_assert(std::has_single_bit(Capacity), "MpscQueue capacity must be a power of two");
+
+private:
+	static constexpr size_t MASK = Capacity - 1;
+
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	std::array<Cell, Capacity> cells;
+
+	// Producers and the consumer work on different ends, keep them on separate cache lines
+	alignas(64) std::atomic<size_t> enqueuePosition{0};
+	alignas(64) size_t dequeuePosition = 0;
+
+public:
+	MpscQueue() {
+		for (size_t i = 0; i < Capacity; i++) {
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	MpscQueue(const MpscQueue &) = delete;
+
+	MpscQueue &operator=(const MpscQueue &) = delete;
+
+	/**
+	 * @brief Add an element, safe to call from any task
+	 *
+	 * @param value The element to add
+	 * @return false if the queue was full and the element was dropped
+	 */
+	bool push(const T &value) {
+		size_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+		while (true) {
+			Cell &cell = cells[position & MASK];
+			const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+			if (difference == 0) {
+				if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					cell.value = value;
+					cell.sequence.store(position + 1, std::memory_order_release);
+
+					return true;
+				}
+			} else if (difference < 0) {
+				// The cell still holds an element from a lap ago
+				return false;
+			} else {
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**
+	 * @brief Remove the oldest element, only call from the consuming task
+	 *
+	 * @param value Set to the removed element
+	 * @return false if the queue was empty
+	 */
+	bool pop(T &value) {
+		Cell &cell = cells[dequeuePosition & MASK];
+
+		if (cell.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) {
+			return false;
+		}
+
+		value = cell.value;
+		cell.sequence.store(dequeuePosition + Capacity, std::memory_order_release);
+		dequeuePosition++;
+
+		return true;
+	}
+};
@@ -1,15 +1,59 @@
 #pragma once
+#include <algorithm>
+#include <cassert>
+#include <memory_resource>
+#include <ranges>
 #include <set>
+#include <vector>
 #include "command.h"
-
-#include <bits/ranges_algo.h>
+#include "commandArena.h"
 
 /**
  * @brief Runs multiple \refitem Command s at once, with the command ending once all individual commands finsh.
  */
 class ParallelCommandGroup : public Command {
 private:
-	std::vector<std::pair<Command *, bool> > commands;
+	std::pmr::vector<std::pair<Command *, bool> > commands;
+
+	// Make sure no two commands in the group require the same subsystem, only in debug builds
+	void checkRequirements() {
+#ifndef NDEBUG
+		auto requirements = this->ParallelCommandGroup::getRequirements();
+
+		const std::set uniqueRequirements(requirements.begin(), requirements.end());
+
+		assert(requirements.size() == uniqueRequirements.size());
+#endif
+	}
+
+	// Set once the groups made by with() in commands have been replaced by their commands
+	bool flattened = false;
+
+	void appendFlattened(std::pmr::vector<std::pair<Command *, bool> > &flat) const {
+		for (const auto command : commands | std::views::keys) {
+			if (flattenable(*command, Composition::Parallel)) {
+				static_cast<const ParallelCommandGroup *>(command)->appendFlattened(flat);
+			} else {
+				flat.emplace_back(command, false);
+			}
+		}
+	}
+
+	// Run the commands of nested with() groups directly, they are never changed so this only happens once
+	void flatten() {
+		flattened = true;
+
+		if (std::ranges::none_of(commands | std::views::keys, [](const Command *command) {
+			return flattenable(*command, Composition::Parallel);
+		})) {
+			return;
+		}
+
+		std::pmr::vector<std::pair<Command *, bool> > flat(commands.get_allocator());
+		appendFlattened(flat);
+
+		commands = std::move(flat);
+	}
 public:
 	/**
 	 * @brief Create a new ParallelCommandGroup given a initializer list of commands
@@ -17,26 +61,47 @@ public:
 	 * @warning No Commands in the parallel can require the same hardware! If this happens the code will immediately
 	 * abort
 	 *
-	 * @param commands Initializer list of \refitem Command s to run in this parallel
+	 * @param commands Initializer list of \refitem Command s to run in this parallel, stored in the
+	 * \refitem CommandArena the group is created in, if any
 	 */
-	ParallelCommandGroup(const std::initializer_list<Command *> commands) {
+	ParallelCommandGroup(const std::initializer_list<Command *> commands) : commands(CommandArena::getResource(this)) {
+		this->commands.reserve(commands.size());
+
 		for (auto command: commands) {
+			hold(*this, *command);
 			this->commands.emplace_back(command, false);
 		}
 
-		auto requirements = this->ParallelCommandGroup::getRequirements();
+		checkRequirements();
+	}
 
-		const std::set uniqueRequirements(requirements.begin(), requirements.end());
+	/**
+	 * @brief Add a command to the end of the group, before it is first scheduled
+	 *
+	 * @details This changes the group everywhere it is used, build a group with add() before handing it out
+	 *
+	 * @param command The command to add
+	 */
+	void add(Command *command) {
+		// Make sure the group isn't running
+		assert(!scheduled());
 
-		assert(requirements.size() == uniqueRequirements.size());
+		hold(*this, *command);
+		commands.emplace_back(command, false);
+
+		checkRequirements();
 	}
 
 	/**
-	 * Initialize all commands in the ParallelCommandGroup
+	 * Initialize all commands in the ParallelCommandGroup, flattening the group the first time
 	 */
 	void initialize() override {
+		if (!flattened) {
+			flatten();
+		}
+
 		for (auto &[command, running]: commands) {
-			command->initialize();
+			command->begin();
 			running = true;
 		}
 	}
@@ -49,9 +114,9 @@ public:
 			if (running) {
 				command->execute();
 
-				if (command->isFinished()) {
+				if (command->done()) {
 					running = false;
-					command->end(false);
+					command->finish(false);
 				}
 			}
 		}
@@ -74,7 +139,7 @@ public:
 	void end(bool interrupted) override {
 		if (interrupted) {
 			for (auto &[command, running]: commands) {
-				command->end(true);
+				command->finish(true);
 				running = true;
 			}
 		}
@@ -99,6 +164,9 @@ public:
 };
 
 inline Command *Command::with(Command *other) {
-	return new ParallelCommandGroup({this, other});
+	ParallelCommandGroup *group = CommandArena::make<ParallelCommandGroup>({this, other});
+	group->composition = Composition::Parallel;
+
+	return group;
 }
 
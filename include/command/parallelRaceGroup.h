@@ -1,14 +1,61 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <memory_resource>
+#include <ranges>
+#include <set>
+#include <vector>
 #include "command.h"
+#include "commandArena.h"
 
 /**
  * @brief Runs multiple \refitem Command s at once, with the command ending once the first command finishes.
  */
 class ParallelRaceGroup : public Command {
 private:
-	std::vector<Command*> commands;
+	std::pmr::vector<std::pair<Command *, bool> > commands;
 	bool isDone = false;
+
+	// Make sure no two commands in the group require the same subsystem, only in debug builds
+	void checkRequirements() {
+#ifndef NDEBUG
+		auto requirements = this->ParallelRaceGroup::getRequirements();
+
+		const std::set uniqueRequirements(requirements.begin(), requirements.end());
+
+		assert(requirements.size() == uniqueRequirements.size());
+#endif
+	}
+
+	// Set once the groups made by race() in commands have been replaced by their commands
+	bool flattened = false;
+
+	void appendFlattened(std::pmr::vector<std::pair<Command *, bool> > &flat) const {
+		for (const auto command : commands | std::views::keys) {
+			if (flattenable(*command, Composition::Race)) {
+				static_cast<const ParallelRaceGroup *>(command)->appendFlattened(flat);
+			} else {
+				flat.emplace_back(command, false);
+			}
+		}
+	}
+
+	// Run the commands of nested race() groups directly, they are never changed so this only happens once
+	void flatten() {
+		flattened = true;
+
+		if (std::ranges::none_of(commands | std::views::keys, [](const Command *command) {
+			return flattenable(*command, Composition::Race);
+		})) {
+			return;
+		}
+
+		std::pmr::vector<std::pair<Command *, bool> > flat(commands.get_allocator());
+		appendFlattened(flat);
+
+		commands = std::move(flat);
+	}
 public:
 	/**
 	 * @brief Create a new ParallelRaceGroup given a initializer list of commands
@@ -16,26 +63,52 @@ public:
 	 * @warning No Commands in the parallel can require the same hardware! If this happens the code will immediately
 	 * abort
 	 *
-	 * @param commands Initializer list of \refitem Command s to run in this parallel
+	 * @param commands Initializer list of \refitem Command s to run in this parallel, stored in the
+	 * \refitem CommandArena the group is created in, if any
 	 */
-	ParallelRaceGroup(const std::initializer_list<Command*> commands) : commands(commands) {
+	ParallelRaceGroup(const std::initializer_list<Command*> commands) : commands(CommandArena::getResource(this)) {
 		isDone = false;
 
-		auto requirements = this->ParallelRaceGroup::getRequirements();
+		this->commands.reserve(commands.size());
 
-		const std::set uniqueRequirements(requirements.begin(), requirements.end());
+		for (auto command : commands) {
+			hold(*this, *command);
+			this->commands.emplace_back(command, false);
+		}
 
-		assert(requirements.size() == uniqueRequirements.size());
+		checkRequirements();
+	}
+
+	/**
+	 * @brief Add a command to the end of the group, before it is first scheduled
+	 *
+	 * @details This changes the group everywhere it is used, build a group with add() before handing it out
+	 *
+	 * @param command The command to add
+	 */
+	void add(Command *command) {
+		// Make sure the group isn't running
+		assert(!scheduled());
+
+		hold(*this, *command);
+		commands.emplace_back(command, false);
+
+		checkRequirements();
 	}
 
 	/**
-	 * Initialize all commands in the ParallelRaceGroup
+	 * Initialize all commands in the ParallelRaceGroup, flattening the group the first time
 	 */
 	void initialize() override {
+		if (!flattened) {
+			flatten();
+		}
+
 		this->isDone = false;
 
-		for (const auto command : commands) {
-			command->initialize();
+		for (auto &[command, running] : commands) {
+			command->begin();
+			running = true;
 		}
 	}
 
@@ -43,12 +116,13 @@ public:
 	 * Runs all the active commands in the ParallelRaceGroup and check if any are done
 	 */
 	void execute() override {
-		for (auto command : commands) {
+		for (auto &[command, running] : commands) {
 			command->execute();
 
-			if (command->isFinished()) {
+			if (command->done()) {
 				this->isDone = true;
-				command->end(false);
+				running = false;
+				command->finish(false);
 			}
 		}
 	}
@@ -68,8 +142,12 @@ public:
 	 * @param interrupted Ends all commands based on if they are done or not
 	 */
 	void end(bool interrupted) override {
-		for (auto command : this->commands) {
-			command->end(!command->isFinished());
+		for (auto &[command, running] : this->commands) {
+			// Commands that finished were already ended by execute
+			if (running) {
+				running = false;
+				command->finish(!command->isFinished());
+			}
 		}
 	}
 
@@ -81,7 +159,7 @@ public:
 	std::vector<Subsystem *> getRequirements() override {
 		std::vector<Subsystem *> requirements;
 
-		for (auto command: commands) {
+		for (auto command: commands | std::views::keys) {
 			for (auto requirement : command->getRequirements()) {
 				requirements.emplace_back(requirement);
 			}
@@ -92,6 +170,9 @@ public:
 };
 
 inline Command *Command::race(Command *other) {
-	return new ParallelRaceGroup({this, other});
+	ParallelRaceGroup *group = CommandArena::make<ParallelRaceGroup>({this, other});
+	group->composition = Composition::Race;
+
+	return group;
 }
 
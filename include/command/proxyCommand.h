@@ -1,6 +1,7 @@
 #pragma once
 
 #include "command.h"
+#include "commandArena.h"
 
 /**
  * @brief Schedules a \refitem Command as a "proxy" while tracking the progress for \refitem Sequence
@@ -11,20 +12,25 @@
 class ProxyCommand : public Command {
 private:
 	Command *command;
-	std::function<Command *()> supplier;
+	InplaceFunction<Command *()> supplier;
 
 public:
 	/**
 	 * @brief Create a ProxyCommand with a \refitem Command pointer supplier
 	 * @param supplier Supplier to get a \refitem Command pointer on initialization
 	 */
-	explicit ProxyCommand(const std::function<Command *()> &supplier) : supplier(supplier) { command = nullptr; }
+	explicit ProxyCommand(InplaceFunction<Command *()> supplier) : supplier(std::move(supplier)) {
+		command = nullptr;
+
+		// Schedules its command and waits for it to run, which needs the scheduler's own task
+		runOnSchedulerTask(*this);
+	}
 
 	/**
 	 * @brief Create a new ProxyCommand with a \refitem Command pointer
 	 * @param command The command to schedule as a proxy
 	 */
-	explicit ProxyCommand(Command *command) : ProxyCommand([command]() { return command; }) {}
+	explicit ProxyCommand(Command *command) : ProxyCommand([command]() { return command; }) { hold(*this, *command); }
 
 	/**
 	 * @brief Initialize the ProxyCommand and putting it into the \refitem CommandScheduler
@@ -62,6 +68,6 @@ public:
 };
 
 inline Command *Command::asProxy() {
-	return new ProxyCommand(this);
+	return CommandArena::make<ProxyCommand>(this);
 }
 
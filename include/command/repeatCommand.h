@@ -1,6 +1,7 @@
 #pragma once
 
 #include "command.h"
+#include "commandArena.h"
 
 /**
  * @brief Makes a \refitem Command repeat each time after it is run
@@ -16,13 +17,14 @@ public:
 	 */
 	explicit RepeatCommand(Command* command) {
 		this->command = command;
+		hold(*this, *command);
 	}
 
 	/**
 	 * @brief Just initializes the \refitem Command
 	 */
 	void initialize() override {
-		command->initialize();
+		command->begin();
 	}
 
 	/**
@@ -31,9 +33,9 @@ public:
 	void execute() override {
 		command->execute();
 
-		if (command->isFinished()) {
-			command->end(false);
-			command->initialize();
+		if (command->done()) {
+			command->finish(false);
+			command->begin();
 		}
 	}
 
@@ -43,7 +45,7 @@ public:
 	 * @param interrupted Ignored, if the command is ended it must be interrupted because it is always restarting
 	 */
 	void end(bool interrupted) override {
-		command->end(true);
+		command->finish(true);
 	}
 
 	/**
@@ -59,6 +61,6 @@ public:
 };
 
 inline Command *Command::repeatedly() {
-	return new RepeatCommand(this);
+	return CommandArena::make<RepeatCommand>(this);
 }
 
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief The maximum number of distinct \refitem Subsystem s that can be used as requirements. Define this before
+ * including the library to raise the limit
+ */
+#ifndef COMMAND_MAX_SUBSYSTEMS
+#define COMMAND_MAX_SUBSYSTEMS 64
+#endif
+
+/**
+ * @brief Fixed width bitmask of \refitem Subsystem IDs, used by the \refitem CommandScheduler to track requirements
+ *
+ * @details Each \refitem Subsystem gets a dense ID from the \refitem CommandScheduler, so checking if two
+ * \refitem Command s conflict is a single AND over a few words instead of a search through the requirement lists.
+ */
+class RequirementMask {
+private:
+	using Word = std::uint32_t;
+
+	static constexpr size_t WORD_BITS = 32;
+	static constexpr size_t WORDS = (COMMAND_MAX_SUBSYSTEMS + WORD_BITS - 1) / WORD_BITS;
+
+	std::array<Word, WORDS> words{};
+
+public:
+	/**
+	 * @brief The number of \refitem Subsystem IDs this mask can hold
+	 */
+	static constexpr size_t CAPACITY = COMMAND_MAX_SUBSYSTEMS;
+
+	/**
+	 * @brief Create an empty RequirementMask
+	 */
+	constexpr RequirementMask() = default;
+
+	/**
+	 * @brief Mark a \refitem Subsystem ID as required
+	 *
+	 * @param id The ID to set
+	 */
+	constexpr void set(const size_t id) { words[id / WORD_BITS] |= Word{1} << (id % WORD_BITS); }
+
+	/**
+	 * @brief Mark a \refitem Subsystem ID as not required
+	 *
+	 * @param id The ID to clear
+	 */
+	constexpr void reset(const size_t id) { words[id / WORD_BITS] &= ~(Word{1} << (id % WORD_BITS)); }
+
+	/**
+	 * @brief Check if a \refitem Subsystem ID is required
+	 *
+	 * @param id The ID to check
+	 * @return True if the ID is set
+	 */
+	[[nodiscard]] constexpr bool test(const size_t id) const {
+		return (words[id / WORD_BITS] >> (id % WORD_BITS)) & Word{1};
+	}
+
+	/**
+	 * @brief Check if any ID is set
+	 *
+	 * @return True if at least one ID is set
+	 */
+	[[nodiscard]] constexpr bool any() const {
+		for (const auto word: words) {
+			if (word != 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Check if no ID is set
+	 *
+	 * @return True if the mask is empty
+	 */
+	[[nodiscard]] constexpr bool none() const { return !any(); }
+
+	/**
+	 * @brief Check if this mask shares any ID with another mask
+	 *
+	 * @param other The mask to compare against
+	 * @return True if the masks overlap
+	 */
+	[[nodiscard]] constexpr bool intersects(const RequirementMask &other) const {
+		for (size_t i = 0; i < WORDS; i++) {
+			if ((words[i] & other.words[i]) != 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Runs a function on every set ID, in ascending order
+	 *
+	 * @param function Function taking the size_t ID
+	 */
+	template<typename F>
+	constexpr void forEach(F &&function) const {
+		for (size_t i = 0; i < WORDS; i++) {
+			Word word = words[i];
+
+			while (word != 0) {
+				function(i * WORD_BITS + std::countr_zero(word));
+				word &= word - 1;
+			}
+		}
+	}
+
+	constexpr RequirementMask &operator|=(const RequirementMask &other) {
+		for (size_t i = 0; i < WORDS; i++) {
+			words[i] |= other.words[i];
+		}
+		return *this;
+	}
+
+	constexpr RequirementMask &operator&=(const RequirementMask &other) {
+		for (size_t i = 0; i < WORDS; i++) {
+			words[i] &= other.words[i];
+		}
+		return *this;
+	}
+
+	constexpr RequirementMask operator~() const {
+		RequirementMask result;
+		for (size_t i = 0; i < WORDS; i++) {
+			result.words[i] = ~words[i];
+		}
+		return result;
+	}
+
+	friend constexpr RequirementMask operator|(RequirementMask lhs, const RequirementMask &rhs) { return lhs |= rhs; }
+
+	friend constexpr RequirementMask operator&(RequirementMask lhs, const RequirementMask &rhs) { return lhs &= rhs; }
+
+	friend constexpr bool operator==(const RequirementMask &lhs, const RequirementMask &rhs) = default;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "command.h"
+#include "instantCommand.h"
 
 /**
  * @brief This \refitem InstantCommand schedules a \refitem Command on object initialization
@@ -13,6 +14,10 @@ public:
 	 */
 	explicit ScheduleCommand(Command* command)
 		: InstantCommand([command]() { command->schedule(); }, {}) {
+		hold(*this, *command);
+
+		// Schedules the command directly instead of queueing it for after the parallel phase
+		runOnSchedulerTask(*this);
 	}
 
 	~ScheduleCommand() override = default;
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include "api.h"
+#include "units/units.hpp"
+
+/**
+ * @brief Time source of the \refitem CommandScheduler, read once per tick as a monotonic count of microseconds
+ *
+ * @details CommandScheduler::run() samples the source at the start of every tick, and \refitem WaitCommand,
+ * withTimeout, \refitem CoroutineCommand waits and debounced \refitem Trigger s all read that sample through now()
+ * instead of the firmware. Every command in a tick sees the same time, a tick costs one clock read however many
+ * timers are running, and the 64-bit count doesn't wrap. The source defaults to pros::micros(). A simulation can
+ * install its own with CommandScheduler::setClock() to step time without waiting for it, which also makes every run
+ * of it the same.
+ *
+ * ```C
+ * std::uint64_t simulatedTime = 0;
+ *
+ * CommandScheduler::setClock([]() { return simulatedTime; });
+ *
+ * for (int i = 0; i < 1500; i++) {
+ *     CommandScheduler::run();
+ *     simulatedTime += 10000;
+ * }
+ * ```
+ *
+ * @warning Only read the time from the scheduler task, or from commands it runs
+ */
+class SchedulerClock {
+public:
+	/**
+	 * @brief Function returning the current time in microseconds, it must never go backwards
+	 */
+	using Source = std::uint64_t (*)();
+
+private:
+	static std::uint64_t defaultSource() { return pros::micros(); }
+
+	static inline Source source = defaultSource;
+	static inline std::uint64_t tickTime = 0;
+	static inline bool sampled = false;
+
+public:
+	/**
+	 * @brief Read the source, called by the \refitem CommandScheduler at the start of every tick
+	 */
+	static void sample() {
+		tickTime = source();
+		sampled = true;
+	}
+
+	/**
+	 * @return The time sampled at the start of the current or last tick, or the source itself before the first tick
+	 */
+	static std::uint64_t now() { return sampled ? tickTime : source(); }
+
+	/**
+	 * @brief Replace the time source, the next tick samples it
+	 *
+	 * @param source The new source, nullptr to go back to pros::micros()
+	 */
+	static void setSource(const Source source) {
+		SchedulerClock::source = source != nullptr ? source : defaultSource;
+		sampled = false;
+	}
+
+	/**
+	 * @brief Forget the last sample, so now() reads the source again until the next tick
+	 */
+	static void reset() { sampled = false; }
+
+	/**
+	 * @brief Convert a duration to the microseconds now() counts in
+	 *
+	 * @param duration The duration to convert, negative durations become 0 and durations too long to count become
+	 * UINT64_MAX
+	 * @return The duration rounded to whole microseconds
+	 */
+	static std::uint64_t toMicros(const units::QTime duration) {
+		const double micros = duration.Convert(units::second) * 1e6 + 0.5;
+
+		// 2^64, the first double that doesn't fit
+		if (!(micros < 18446744073709551616.0)) {
+			return micros > 0.0 ? UINT64_MAX : 0;
+		}
+
+		return micros > 0.0 ? static_cast<std::uint64_t>(micros) : 0;
+	}
+};
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include "api.h"
+#include "commandScheduler.h"
+#include "schedulerClock.h"
+#include "seqLock.h"
+#include "units/units.hpp"
+
+/**
+ * @brief The number of worst late or overrunning ticks a \refitem SchedulerRunner keeps
+ */
+#ifndef COMMAND_RUNNER_WORST_TICKS
+#define COMMAND_RUNNER_WORST_TICKS 16
+#endif
+
+/**
+ * @brief How far past the target period in microseconds a tick can start before it counts as late. pros::c::
+ * task_delay_until works in milliseconds, so up to a millisecond of jitter is expected
+ */
+#ifndef COMMAND_RUNNER_LATE_TOLERANCE
+#define COMMAND_RUNNER_LATE_TOLERANCE 1000
+#endif
+
+/**
+ * @brief Timing of one tick of a \refitem SchedulerRunner, in microseconds
+ */
+struct TickSample {
+	/**
+	 * pros::micros() at the start of the tick
+	 */
+	std::uint64_t start = 0;
+
+	/**
+	 * Time since the start of the previous tick, 0 for the first tick
+	 */
+	std::uint32_t period = 0;
+
+	/**
+	 * Time spent in CommandScheduler::run()
+	 */
+	std::uint32_t execution = 0;
+};
+
+/**
+ * @brief Timing statistics of a \refitem SchedulerRunner, in microseconds, published at the end of every tick
+ */
+struct RunnerStats {
+	/**
+	 * The last tick
+	 */
+	TickSample lastTick{};
+
+	std::uint32_t ticks = 0;
+
+	/**
+	 * Ticks whose execution took longer than the period
+	 */
+	std::uint32_t overruns = 0;
+
+	/**
+	 * Ticks that started more than COMMAND_RUNNER_LATE_TOLERANCE after the period
+	 */
+	std::uint32_t lateTicks = 0;
+
+	std::uint64_t executionTotal = 0;
+	std::uint32_t executionMax = 0;
+
+	/**
+	 * Sum and maximum of the absolute difference between the measured and target period
+	 */
+	std::uint64_t jitterTotal = 0;
+	std::uint32_t jitterMax = 0;
+
+	std::uint32_t periodMin = UINT32_MAX;
+	std::uint32_t periodMax = 0;
+
+	/**
+	 * Worst late or overrunning ticks, sorted from worst to least bad, the first worstCount are valid
+	 */
+	std::array<TickSample, COMMAND_RUNNER_WORST_TICKS> worstTicks{};
+	std::uint32_t worstCount = 0;
+};
+
+/**
+ * @brief Runs the \refitem CommandScheduler in its own task at a fixed period and records how consistently it does
+ *
+ * @details Every tick measures the actual period and the execution time of CommandScheduler::run() with
+ * pros::micros(). A tick overruns when its execution takes longer than the target period, and is late when it starts
+ * more than COMMAND_RUNNER_LATE_TOLERANCE after the target period. The late or overrunning ticks that went furthest
+ * past the target period are kept in a fixed-size array, so nothing allocates while running.
+ *
+ * The statistics are published in a \refitem SeqLock at the end of every tick, so any task can read them, for
+ * example a screen or logging task. Only resetStats() has to be called from the scheduler task once start() is
+ * called, debug builds assert this.
+ *
+ * @warning A SchedulerRunner or a loop similar to it must be running to ensure the \refitem CommandScheduler is run
+ */
+class SchedulerRunner {
+private:
+	std::uint32_t periodMillis;
+	std::uint32_t priority;
+	pros::task_t task = nullptr;
+
+	std::uint64_t previousStart = 0;
+	bool hasPrevious = false;
+
+	// Written by the task running tick(), and copied to published for other tasks at the end of every tick
+	RunnerStats stats{};
+	SeqLock<RunnerStats> published;
+
+	[[noreturn]] void loop() {
+		// Set once, task_delay_until advances it by the period so an overrun doesn't shift later ticks
+		auto start_time = pros::millis();
+
+		while (true) {
+			tick();
+
+			pros::c::task_delay_until(&start_time, periodMillis);
+		}
+	}
+
+	// How far a tick went past the target period, by its execution or by starting late
+	[[nodiscard]] std::uint32_t severity(const TickSample &sample) const {
+		const std::uint32_t target = getPeriodMicros();
+
+		return std::max(sample.execution > target ? sample.execution - target : 0,
+		                sample.period > target ? sample.period - target : 0);
+	}
+
+	// Keep the sample if it is worse than the least bad one kept
+	void recordWorst(const TickSample &sample) {
+		auto &worstTicks = stats.worstTicks;
+		const size_t worstCount = stats.worstCount;
+		const std::uint32_t value = severity(sample);
+
+		if (worstCount == worstTicks.size() && value <= severity(worstTicks[worstCount - 1])) {
+			return;
+		}
+
+		size_t i = std::min(worstCount, worstTicks.size() - 1);
+
+		while (i > 0 && severity(worstTicks[i - 1]) < value) {
+			worstTicks[i] = worstTicks[i - 1];
+			i--;
+		}
+
+		worstTicks[i] = sample;
+		stats.worstCount = static_cast<std::uint32_t>(std::min(worstCount + 1, worstTicks.size()));
+	}
+
+	// Writers other than tick() have to be on the task running it
+	void checkWriter() const {
+		assert(task == nullptr || pros::c::task_get_current() == task);
+	}
+
+	// Round a period to whole milliseconds, at least 1 and short enough for getPeriodMicros
+	static std::uint32_t toMillis(const units::QTime period) {
+		const std::uint64_t micros = SchedulerClock::toMicros(period);
+		const std::uint64_t millis = micros / 1000 + (micros % 1000 >= 500 ? 1 : 0);
+
+		return static_cast<std::uint32_t>(std::clamp<std::uint64_t>(millis, 1, UINT32_MAX / 1000));
+	}
+
+public:
+	/**
+	 * @brief Create a runner, call start() to begin running the scheduler
+	 *
+	 * @details Sets the \refitem CommandScheduler period, so create the runner before registering subsystems
+	 *
+	 * @param period Target time between the start of each tick, rounded to whole milliseconds
+	 * @param priority PROS priority of the scheduler task
+	 */
+	explicit SchedulerRunner(const units::QTime period = 10.0 * units::millisecond,
+	                         const std::uint32_t priority = TASK_PRIORITY_DEFAULT)
+		: periodMillis(toMillis(period)),
+		  priority(priority) {
+		CommandScheduler::setPeriod(periodMillis * units::millisecond);
+	}
+
+	SchedulerRunner(const SchedulerRunner &) = delete;
+
+	SchedulerRunner &operator=(const SchedulerRunner &) = delete;
+
+	/**
+	 * @brief Start the scheduler task, does nothing if it is already running
+	 *
+	 * @details From then on schedule(), cancel() and registerSubsystem() calls from other tasks are queued for the
+	 * scheduler task, see CommandScheduler::setOwner
+	 */
+	void start() {
+		if (task == nullptr) {
+			task = pros::Task::create([this]() { loop(); }, priority, TASK_STACK_DEPTH_DEFAULT, "CommandScheduler");
+
+			CommandScheduler::setOwner(task);
+		}
+	}
+
+	/**
+	 * @brief Run the scheduler once and record its timing, called by the task every period
+	 *
+	 * @details Call this directly instead of start() to drive the scheduler from an existing loop
+	 */
+	void tick() {
+		const std::uint64_t start = pros::micros();
+
+		CommandScheduler::run();
+
+		const std::uint64_t end = pros::micros();
+
+		TickSample sample;
+		sample.start = start;
+		sample.period = hasPrevious ? static_cast<std::uint32_t>(start - previousStart) : 0;
+		sample.execution = static_cast<std::uint32_t>(end - start);
+
+		previousStart = start;
+
+		const std::uint32_t target = getPeriodMicros();
+		const bool overran = sample.execution > target;
+		bool late = false;
+
+		stats.ticks++;
+		stats.executionTotal += sample.execution;
+		stats.executionMax = std::max(stats.executionMax, sample.execution);
+
+		if (hasPrevious) {
+			const std::uint32_t jitter = sample.period > target ? sample.period - target : target - sample.period;
+
+			stats.jitterTotal += jitter;
+			stats.jitterMax = std::max(stats.jitterMax, jitter);
+			stats.periodMin = std::min(stats.periodMin, sample.period);
+			stats.periodMax = std::max(stats.periodMax, sample.period);
+
+			late = sample.period > target + COMMAND_RUNNER_LATE_TOLERANCE;
+		}
+
+		hasPrevious = true;
+
+		stats.overruns += overran;
+		stats.lateTicks += late;
+
+		if (overran || late) {
+			recordWorst(sample);
+		}
+
+		stats.lastTick = sample;
+
+		published.store(stats);
+	}
+
+	/**
+	 * @brief Clear all recorded timing, the next tick won't have a measured period. Only call this from the scheduler
+	 * task once the runner has started
+	 */
+	void resetStats() {
+		checkWriter();
+
+		hasPrevious = false;
+		stats = {};
+
+		published.store(stats);
+	}
+
+	[[nodiscard]] std::uint32_t getPeriodMicros() const { return periodMillis * 1000; }
+
+	[[nodiscard]] std::uint32_t getPriority() const { return priority; }
+
+	/**
+	 * @return The task running the scheduler, nullptr until start() is called
+	 */
+	[[nodiscard]] pros::task_t getTask() const { return task; }
+
+	/**
+	 * @brief Get all the statistics as of the end of the last tick, from any task
+	 *
+	 * @return A consistent copy of the statistics, the getters below each take their own copy
+	 */
+	[[nodiscard]] RunnerStats getStats() const { return published.load(); }
+
+	[[nodiscard]] TickSample getLastTick() const { return getStats().lastTick; }
+
+	[[nodiscard]] std::uint32_t getTicks() const { return getStats().ticks; }
+
+	/**
+	 * @return The number of ticks whose execution took longer than the period
+	 */
+	[[nodiscard]] std::uint32_t getOverruns() const { return getStats().overruns; }
+
+	/**
+	 * @return The number of ticks that started more than COMMAND_RUNNER_LATE_TOLERANCE after the period
+	 */
+	[[nodiscard]] std::uint32_t getLateTicks() const { return getStats().lateTicks; }
+
+	[[nodiscard]] std::uint32_t getMaxExecution() const { return getStats().executionMax; }
+
+	[[nodiscard]] double getMeanExecution() const {
+		const RunnerStats current = getStats();
+		return current.ticks == 0 ? 0.0 : static_cast<double>(current.executionTotal) / current.ticks;
+	}
+
+	[[nodiscard]] std::uint32_t getMinPeriod() const {
+		const RunnerStats current = getStats();
+		return current.ticks < 2 ? 0 : current.periodMin;
+	}
+
+	[[nodiscard]] std::uint32_t getMaxPeriod() const { return getStats().periodMax; }
+
+	[[nodiscard]] std::uint32_t getMaxJitter() const { return getStats().jitterMax; }
+
+	[[nodiscard]] double getMeanJitter() const {
+		const RunnerStats current = getStats();
+		return current.ticks < 2 ? 0.0 : static_cast<double>(current.jitterTotal) / (current.ticks - 1);
+	}
+
+	/**
+	 * @brief Get the late or overrunning ticks that went furthest past the target period, by execution time or by
+	 * starting late
+	 *
+	 * @return Up to COMMAND_RUNNER_WORST_TICKS samples, worst first
+	 */
+	[[nodiscard]] std::vector<TickSample> getWorstTicks() const {
+		const RunnerStats current = getStats();
+		return {current.worstTicks.begin(), current.worstTicks.begin() + current.worstCount};
+	}
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief Holds a copy of a value that one task writes and any number of tasks read, without locks or allocation
+ *
+ * @details The writer alternates between two slots and publishes which one is current, so a reader copies a slot the
+ * writer isn't working on. A reader only has to retry when the writer finished a store and started the one after it
+ * while the reader was copying, which can't happen when the reader has a higher priority than the writer, so a reader
+ * never spins waiting for a preempted writer.
+ *
+ * The slots are stored as relaxed atomic words, so a torn copy is detected and thrown away instead of being a data
+ * race.
+ *
+ * @tparam T Type of the value, it must be trivially copyable
+ */
+template<typename T>
+class SeqLock {
+	static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied word by word");
+
+private:
+	static constexpr size_t WORDS = (sizeof(T) + sizeof(std::uint32_t) - 1) / sizeof(std::uint32_t);
+
+	using Words = std::array<std::uint32_t, WORDS>;
+
+	std::array<std::array<std::atomic<std::uint32_t>, WORDS>, 2> slots{};
+
+	// Number of the store that was started last and of the store that was finished last, store n writes slot n % 2
+	std::atomic<std::uint32_t> started{0};
+	std::atomic<std::uint32_t> finished{0};
+
+public:
+	/**
+	 * @brief Create a SeqLock holding a value
+	 *
+	 * @param value The value readers get until the first store
+	 */
+	explicit SeqLock(const T &value = T{}) { store(value); }
+
+	SeqLock(const SeqLock &) = delete;
+
+	SeqLock &operator=(const SeqLock &) = delete;
+
+	/**
+	 * @brief Publish a new value, only call this from one task
+	 *
+	 * @param value The value to publish
+	 */
+	void store(const T &value) {
+		Words words{};
+		std::memcpy(words.data(), &value, sizeof(T));
+
+		const std::uint32_t next = finished.load(std::memory_order_relaxed) + 1;
+		auto &slot = slots[next & 1];
+
+		started.store(next, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		for (size_t i = 0; i < WORDS; i++) {
+			slot[i].store(words[i], std::memory_order_relaxed);
+		}
+
+		finished.store(next, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Get the last published value, from any task
+	 *
+	 * @return A copy of the value from the last finished store
+	 */
+	[[nodiscard]] T load() const {
+		Words words;
+
+		while (true) {
+			const std::uint32_t current = finished.load(std::memory_order_acquire);
+			const auto &slot = slots[current & 1];
+
+			for (size_t i = 0; i < WORDS; i++) {
+				words[i] = slot[i].load(std::memory_order_relaxed);
+			}
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			// The slot is only written again by the store two after current
+			if (started.load(std::memory_order_relaxed) - current < 2) {
+				break;
+			}
+		}
+
+		T value;
+		std::memcpy(static_cast<void *>(&value), words.data(), sizeof(T));
+
+		return value;
+	}
+};
@@ -1,7 +1,11 @@
 #pragma once
 
-#include "command.h"
 #include <algorithm>
+#include <cassert>
+#include <memory_resource>
+#include <vector>
+#include "command.h"
+#include "commandArena.h"
 
 /**
  * @brief This \refitem Command that runs multiple \refitem Command s in a row.
@@ -9,24 +13,75 @@
 class Sequence : public Command {
 private:
 	size_t index = 0;
-	std::vector<Command*> commands;
+	std::pmr::vector<Command*> commands;
+
+	// Set once the sequences made by andThen() in commands have been replaced by their commands
+	bool flattened = false;
+
+	void appendFlattened(std::pmr::vector<Command*> &flat) const {
+		for (Command* command : commands) {
+			if (flattenable(*command, Composition::Sequence)) {
+				static_cast<const Sequence *>(command)->appendFlattened(flat);
+			} else {
+				flat.push_back(command);
+			}
+		}
+	}
+
+	// Run the commands of nested andThen() sequences directly, they are never changed so this only happens once
+	void flatten() {
+		flattened = true;
+
+		if (std::ranges::none_of(commands, [](const Command* command) {
+			return flattenable(*command, Composition::Sequence);
+		})) {
+			return;
+		}
+
+		std::pmr::vector<Command*> flat(commands.get_allocator());
+		appendFlattened(flat);
+
+		commands = std::move(flat);
+	}
 public:
 	/**
 	 * Creates a new object that runs a series of commands one after another
 	 *
-	 * @param commands Initializer list for sequence Commands
+	 * @param commands Initializer list for sequence Commands, stored in the \refitem CommandArena the sequence is
+	 * created in, if any
 	 */
-	Sequence(const std::initializer_list<Command*> commands) : commands(commands) {
+	Sequence(const std::initializer_list<Command*> commands) : commands(commands, CommandArena::getResource(this)) {
+		for (Command* command : commands) {
+			hold(*this, *command);
+		}
+	}
 
+	/**
+	 * @brief Add a command to the end of the sequence, before it is first scheduled
+	 *
+	 * @details This changes the sequence everywhere it is used, build a sequence with add() before handing it out
+	 *
+	 * @param command The command to add
+	 */
+	void add(Command* command) {
+		// Make sure the sequence isn't running
+		assert(!scheduled());
+
+		hold(*this, *command);
+		commands.push_back(command);
 	}
 
 	/**
-	 * @brief Initializes the first command
+	 * @brief Initializes the first command, flattening the sequence the first time
 	 */
 	void initialize() override {
+		if (!flattened) {
+			flatten();
+		}
+
 		index = 0;
 
-		commands[0]->initialize();
+		commands[0]->begin();
 	}
 
 	/**
@@ -35,11 +90,11 @@ public:
 	void execute() override {
 		commands[index]->execute();
 
-		if (commands[index]->isFinished()) {
-			commands[index]->end(false);
+		if (commands[index]->done()) {
+			commands[index]->finish(false);
 			index++;
 			if (index < commands.size()) {
-				commands[index]->initialize();
+				commands[index]->begin();
 			}
 		}
 	}
@@ -60,7 +115,7 @@ public:
 	 */
 	void end(const bool interrupted) override {
 		if (index < commands.size()) {
-			commands[index]->end(interrupted);
+			commands[index]->finish(interrupted);
 		}
 	}
 
@@ -85,5 +140,8 @@ public:
 };
 
 inline Command *Command::andThen(Command *other) {
-	return new Sequence({this, other});
+	Sequence *sequence = CommandArena::make<Sequence>({this, other});
+	sequence->composition = Composition::Sequence;
+
+	return sequence;
 }
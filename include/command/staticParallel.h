@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <set>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "command.h"
+
+/**
+ * @brief A \refitem ParallelCommandGroup whose \refitem Command s are stored by value and dispatched at compile time
+ *
+ * @details The children are kept in a std::tuple inside the StaticParallel, so building one makes no allocations and
+ * every call into a child is a direct, non-virtual call. The command ends once all children have finished.
+ *
+ * @warning No Commands in the parallel can require the same hardware! If this happens the code will immediately abort
+ *
+ * @tparam Commands The \refitem Command types to run at the same time
+ */
+template<typename... Commands>
+class StaticParallel : public Command {
+	static_assert(sizeof...(Commands) > 0, "StaticParallel needs at least one command");
+	static_assert((std::is_base_of_v<Command, Commands> && ...), "StaticParallel children must be Commands");
+
+private:
+	static constexpr size_t SIZE = sizeof...(Commands);
+
+	std::tuple<Commands...> commands;
+	std::array<bool, SIZE> running{};
+
+	// Calls function on every child with its index, unrolled at compile time
+	template<typename F>
+	void forEach(F &&function) {
+		[this, &function]<size_t... I>(std::index_sequence<I...>) {
+			(function.template operator()<I>(std::get<I>(commands)), ...);
+		}(std::make_index_sequence<SIZE>{});
+	}
+
+	template<size_t I>
+	using Child = std::tuple_element_t<I, std::tuple<Commands...>>;
+
+public:
+	/**
+	 * @brief Create a new StaticParallel from the \refitem Command s to run
+	 *
+	 * @param commands The \refitem Command s, copied or moved into this StaticParallel
+	 */
+	explicit StaticParallel(Commands... commands) : commands(std::move(commands)...) {
+		// Children are owned by the parallel and must never be scheduled on their own
+		std::apply([](auto &...command) { assert((!command.scheduled() && ...)); }, this->commands);
+
+		// Keep the group on the scheduler task if a child has to run there
+		std::apply([this](auto &...command) { (hold(*this, command), ...); }, this->commands);
+
+		auto requirements = this->StaticParallel::getRequirements();
+
+		const std::set uniqueRequirements(requirements.begin(), requirements.end());
+
+		assert(requirements.size() == uniqueRequirements.size());
+	}
+
+	/**
+	 * Initialize all commands in the StaticParallel
+	 */
+	void initialize() override {
+		forEach([this]<size_t I>(Child<I> &command) {
+			using T = Child<I>;
+
+			startLimits(command);
+			command.T::initialize();
+			running[I] = true;
+		});
+	}
+
+	/**
+	 * Runs all the active commands in the StaticParallel
+	 */
+	void execute() override {
+		forEach([this]<size_t I>(Child<I> &command) {
+			using T = Child<I>;
+
+			if (running[I]) {
+				command.T::execute();
+
+				if (command.T::isFinished() || limitReached(command)) {
+					running[I] = false;
+					command.T::end(endInterrupted(command, false));
+				}
+			}
+		});
+	}
+
+	/**
+	 * @brief Returns true if all commands are finished
+	 *
+	 * @return True if all commands are finished
+	 */
+	bool isFinished() override {
+		for (const bool active: running) {
+			if (active) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Ends the commands that are still running as interrupted
+	 *
+	 * @param interrupted Only the unfinished commands are ended, and only if this is true
+	 */
+	void end(const bool interrupted) override {
+		if (interrupted) {
+			forEach([this]<size_t I>(Child<I> &command) {
+				using T = Child<I>;
+
+				if (running[I]) {
+					command.T::end(true);
+					running[I] = false;
+				}
+			});
+		}
+	}
+
+	/**
+	 * @brief Gets all the required subsystems for this StaticParallel
+	 *
+	 * @return Set of all requirements of all the command
+	 */
+	std::vector<Subsystem *> getRequirements() override {
+		std::vector<Subsystem *> requirements;
+
+		forEach([&requirements]<size_t I>(Child<I> &command) {
+			for (auto requirement: command.getRequirements()) {
+				requirements.emplace_back(requirement);
+			}
+		});
+
+		return requirements;
+	}
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <set>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "command.h"
+
+/**
+ * @brief A \refitem ParallelRaceGroup whose \refitem Command s are stored by value and dispatched at compile time
+ *
+ * @details The children are kept in a std::tuple inside the StaticRace, so building one makes no allocations and
+ * every call into a child is a direct, non-virtual call. The command ends once the first child finishes.
+ *
+ * @warning No Commands in the race can require the same hardware! If this happens the code will immediately abort
+ *
+ * @tparam Commands The \refitem Command types to race
+ */
+template<typename... Commands>
+class StaticRace : public Command {
+	static_assert(sizeof...(Commands) > 0, "StaticRace needs at least one command");
+	static_assert((std::is_base_of_v<Command, Commands> && ...), "StaticRace children must be Commands");
+
+private:
+	static constexpr size_t SIZE = sizeof...(Commands);
+
+	std::tuple<Commands...> commands;
+	std::array<bool, SIZE> running{};
+	bool isDone = false;
+
+	// Calls function on every child with its index, unrolled at compile time
+	template<typename F>
+	void forEach(F &&function) {
+		[this, &function]<size_t... I>(std::index_sequence<I...>) {
+			(function.template operator()<I>(std::get<I>(commands)), ...);
+		}(std::make_index_sequence<SIZE>{});
+	}
+
+	template<size_t I>
+	using Child = std::tuple_element_t<I, std::tuple<Commands...>>;
+
+public:
+	/**
+	 * @brief Create a new StaticRace from the \refitem Command s to race
+	 *
+	 * @param commands The \refitem Command s, copied or moved into this StaticRace
+	 */
+	explicit StaticRace(Commands... commands) : commands(std::move(commands)...) {
+		// Children are owned by the race and must never be scheduled on their own
+		std::apply([](auto &...command) { assert((!command.scheduled() && ...)); }, this->commands);
+
+		// Keep the group on the scheduler task if a child has to run there
+		std::apply([this](auto &...command) { (hold(*this, command), ...); }, this->commands);
+
+		auto requirements = this->StaticRace::getRequirements();
+
+		const std::set uniqueRequirements(requirements.begin(), requirements.end());
+
+		assert(requirements.size() == uniqueRequirements.size());
+	}
+
+	/**
+	 * Initialize all commands in the StaticRace
+	 */
+	void initialize() override {
+		isDone = false;
+
+		forEach([this]<size_t I>(Child<I> &command) {
+			using T = Child<I>;
+
+			startLimits(command);
+			command.T::initialize();
+			running[I] = true;
+		});
+	}
+
+	/**
+	 * Runs all the commands in the StaticRace and check if any are done
+	 */
+	void execute() override {
+		forEach([this]<size_t I>(Child<I> &command) {
+			using T = Child<I>;
+
+			if (running[I]) {
+				command.T::execute();
+
+				if (command.T::isFinished() || limitReached(command)) {
+					isDone = true;
+					running[I] = false;
+					command.T::end(endInterrupted(command, false));
+				}
+			}
+		});
+	}
+
+	/**
+	 * @brief Returns true if any commands is finished
+	 *
+	 * @return True if any commands is finished
+	 */
+	bool isFinished() override { return isDone; }
+
+	/**
+	 * @brief Ends all commands that didn't finish as interrupted
+	 *
+	 * @param interrupted Ignored, the commands that lost the race are always interrupted
+	 */
+	void end(bool interrupted) override {
+		forEach([this]<size_t I>(Child<I> &command) {
+			using T = Child<I>;
+
+			if (running[I]) {
+				command.T::end(true);
+				running[I] = false;
+			}
+		});
+	}
+
+	/**
+	 * @brief Gets all the required subsystems for this StaticRace
+	 *
+	 * @return Set of all requirements of all the command
+	 */
+	std::vector<Subsystem *> getRequirements() override {
+		std::vector<Subsystem *> requirements;
+
+		forEach([&requirements]<size_t I>(Child<I> &command) {
+			for (auto requirement: command.getRequirements()) {
+				requirements.emplace_back(requirement);
+			}
+		});
+
+		return requirements;
+	}
+};
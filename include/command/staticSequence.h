@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "command.h"
+
+/**
+ * @brief A \refitem Sequence whose \refitem Command s are stored by value and dispatched at compile time
+ *
+ * @details The children are kept in a std::tuple inside the StaticSequence, so building one makes no allocations and
+ * every call into a child is a direct, non-virtual call. The StaticSequence itself is still a \refitem Command, so it
+ * can be scheduled or used inside other groups.
+ *
+ * ```C
+ * auto routine = StaticSequence(WaitCommand(500_ms), RunCommand([]() { intake.setPct(1.0); }, {&intake}));
+ *
+ * routine.schedule();
+ * ```
+ *
+ * @tparam Commands The \refitem Command types to run in order
+ */
+template<typename... Commands>
+class StaticSequence : public Command {
+	static_assert(sizeof...(Commands) > 0, "StaticSequence needs at least one command");
+	static_assert((std::is_base_of_v<Command, Commands> && ...), "StaticSequence children must be Commands");
+
+private:
+	static constexpr size_t SIZE = sizeof...(Commands);
+
+	std::tuple<Commands...> commands;
+	size_t index = 0;
+
+	// Calls function on the child at index, the chain of compares is resolved into direct calls at compile time
+	template<size_t I = 0, typename F>
+	void visit(const size_t i, F &&function) {
+		if constexpr (I < SIZE) {
+			if (i == I) {
+				function.template operator()<I>(std::get<I>(commands));
+			} else {
+				visit<I + 1>(i, std::forward<F>(function));
+			}
+		}
+	}
+
+	template<size_t I>
+	using Child = std::tuple_element_t<I, std::tuple<Commands...>>;
+
+	static void appendRequirements(std::vector<Subsystem *> &requirements, Command &command) {
+		for (auto subsystem: command.getRequirements()) {
+			if (std::ranges::find(requirements, subsystem) == requirements.end()) {
+				requirements.emplace_back(subsystem);
+			}
+		}
+	}
+
+public:
+	/**
+	 * @brief Create a new StaticSequence from the \refitem Command s to run, in order
+	 *
+	 * @param commands The \refitem Command s, copied or moved into this StaticSequence
+	 */
+	explicit StaticSequence(Commands... commands) : commands(std::move(commands)...) {
+		// Children are owned by the sequence and must never be scheduled on their own
+		std::apply([](auto &...command) { assert((!command.scheduled() && ...)); }, this->commands);
+
+		// Keep the group on the scheduler task if a child has to run there
+		std::apply([this](auto &...command) { (hold(*this, command), ...); }, this->commands);
+	}
+
+	/**
+	 * @brief Initializes the first command
+	 */
+	void initialize() override {
+		using First = Child<0>;
+
+		index = 0;
+
+		startLimits(std::get<0>(commands));
+		std::get<0>(commands).First::initialize();
+	}
+
+	/**
+	 * @brief Execute the current command, and step through when it's done
+	 */
+	void execute() override {
+		visit(index, [this]<size_t I>(Child<I> &command) {
+			using T = Child<I>;
+
+			command.T::execute();
+
+			if (command.T::isFinished() || limitReached(command)) {
+				command.T::end(endInterrupted(command, false));
+				index++;
+
+				if constexpr (I + 1 < SIZE) {
+					using Next = Child<I + 1>;
+
+					startLimits(std::get<I + 1>(commands));
+					std::get<I + 1>(commands).Next::initialize();
+				}
+			}
+		});
+	}
+
+	/**
+	 * Finishes when the last command is finished
+	 *
+	 * @return Checks if it has completed the last command
+	 */
+	bool isFinished() override { return index >= SIZE; }
+
+	/**
+	 * @brief Ends the correct Command when the StaticSequence is interrupted
+	 *
+	 * @param interrupted End the last command if it was interrupted
+	 */
+	void end(const bool interrupted) override {
+		visit(index, [interrupted]<size_t I>(Child<I> &command) {
+			using T = Child<I>;
+
+			command.T::end(endInterrupted(command, interrupted));
+		});
+	}
+
+	/**
+	 * @brief Returns the requirements the StaticSequence needs for each step.
+	 *
+	 * @return Returns a set of all the requirements of all the Commands in the sequence
+	 */
+	std::vector<Subsystem *> getRequirements() override {
+		std::vector<Subsystem *> requirements;
+
+		std::apply([&requirements](auto &...command) { (appendRequirements(requirements, command), ...); }, commands);
+
+		return requirements;
+	}
+};
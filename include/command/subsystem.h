@@ -1,15 +1,61 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include "executionProfile.h"
+#include "units/units.hpp"
+
 /**
  * @brief Abstract class for subsystem behaviors. Look at the [annotated intake example](../tutorials/intakeExample.md)
  * for a more in depth solution
  */
 class Subsystem {
+private:
+	friend class CommandScheduler;
+
+	static constexpr size_t UNASSIGNED_ID = static_cast<size_t>(-1);
+
+	/**
+	 * Dense ID assigned by the \refitem CommandScheduler, used as the bit index in \refitem RequirementMask
+	 */
+	size_t id = UNASSIGNED_ID;
+
+	// periodic runs on ticks where the scheduler tick count % rateDivisor == ratePhase
+	std::uint32_t rateDivisor = 1;
+	std::uint32_t ratePhase = 0;
+
+	// Time spent in periodic, empty unless COMMAND_PROFILING is defined
+	[[no_unique_address]] ExecutionProfile profile;
+
 public:
 	/**
 	 * Period is run every frame by the \refitem CommandScheduler useful for debugging tasks and feedback controllers
 	 * that need to run every frame
 	 */
 	virtual void periodic() = 0;
+
+	/**
+	 * @brief How often periodic should run, defaults to every \refitem CommandScheduler tick
+	 *
+	 * @details The period is rounded to a whole number of scheduler periods, see CommandScheduler::setPeriod, and
+	 * subsystems with the same period are spread across different ticks. This is read once when the subsystem is
+	 * registered.
+	 *
+	 * ```C
+	 * // Telemetry only needs to be sent at 10Hz
+	 * units::QTime getPeriod() override { return 100_ms; }
+	 * ```
+	 *
+	 * @return Time between calls to periodic, 0 to run every tick
+	 */
+	virtual units::QTime getPeriod() { return 0.0 * units::second; }
+
+	/**
+	 * @brief Get the timing statistics of periodic, only recorded when COMMAND_PROFILING is defined
+	 *
+	 * @return Time spent in each periodic call
+	 */
+	[[nodiscard]] const ExecutionProfile &getProfile() const { return profile; }
+
 	virtual ~Subsystem() = default;
 };
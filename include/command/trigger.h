@@ -1,16 +1,55 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
 #include "commandScheduler.h"
 #include "eventLoop.h"
+#include "schedulerClock.h"
+#include "units/units.hpp"
 
 /**
  * This class allows for easy triggering of Commands based on boolean inputs
+ *
+ * @details A Trigger is a node in the condition DAG of its \refitem EventLoop, so copies of a Trigger share one
+ * evaluation per poll. Triggers can be combined with &&, ||, !, debounce() and risingEdge(), and each part of the
+ * expression is still evaluated at most once per poll however many triggers use it.
+ *
+ * Every Trigger and binding holds a reference to its node. Once the Trigger is destroyed and its bindings are
+ * removed, such as by resetting the CommandArena they were made in, the node and its condition are removed from the
+ * event loop. A Trigger made before its event loop was cleared must not be used after the clear, but can still be
+ * destroyed.
+ *
+ * ```C
+ * // Chord, only runs when both shoulder buttons are held
+ * (*primary.getTrigger(DIGITAL_L1) && *primary.getTrigger(DIGITAL_R1)).onTrue(command);
+ *
+ * // Ignore limit switch bounce shorter than 20ms
+ * Trigger([]() { return limitSwitch.get_value(); }).debounce(20_ms).onTrue(command);
+ * ```
  */
 class Trigger {
 private:
-	std::function<bool()> condition;
 	EventLoop *eventLoop;
 
+	// Index of this trigger's node in the event loop, which this trigger holds a reference to
+	size_t node;
+
+	// Clear count of the event loop when the node was added, the node is gone once the loop is cleared again
+	std::uint32_t clears;
+
+	// Takes over the reference returned by one of the event loop's add functions
+	Trigger(EventLoop *event_loop, const size_t node)
+		: eventLoop(event_loop), node(node), clears(event_loop->getClearCount()) {}
+
+	[[nodiscard]] bool cleared() const { return eventLoop->getClearCount() != clears; }
+
+	Trigger *addBinding(const TriggerMode mode, Command *command) {
+		eventLoop->bind(node, mode, command);
+
+		return this;
+	}
+
 public:
 	/**
 	 * @brief Create a Trigger with a specified condition and \refitem EventLoop
@@ -18,16 +57,104 @@ public:
 	 * @param condition The condition for the Trigger
 	 * @param event_loop The \refitem EventLoop for the condition to run on
 	 */
-	Trigger(std::function<bool()> condition, EventLoop *event_loop) :
-		condition(std::move(condition)), eventLoop(event_loop) {}
+	Trigger(InplaceFunction<bool()> condition, EventLoop *event_loop) :
+		Trigger(event_loop, event_loop->addCondition(std::move(condition))) {}
 
 	/**
 	 * @brief Create a Trigger with a specified condition and the default \refitem CommandScheduler \refitem EventLoop
 	 *
 	 * @param condition The condition for the Trigger
 	 */
-	explicit Trigger(std::function<bool()> condition) : condition(std::move(condition)) {
-		eventLoop = CommandScheduler::getEventLoop();
+	explicit Trigger(InplaceFunction<bool()> condition) :
+		Trigger(std::move(condition), CommandScheduler::getEventLoop()) {}
+
+	Trigger(const Trigger &other) : eventLoop(other.eventLoop), node(other.node), clears(other.clears) {
+		if (!cleared()) {
+			eventLoop->retain(node);
+		}
+	}
+
+	Trigger &operator=(const Trigger &other) {
+		// Retain first, releasing could remove a node the other trigger still needs
+		if (!other.cleared()) {
+			other.eventLoop->retain(other.node);
+		}
+
+		if (!cleared()) {
+			eventLoop->release(node);
+		}
+
+		eventLoop = other.eventLoop;
+		node = other.node;
+		clears = other.clears;
+
+		return *this;
+	}
+
+	/**
+	 * @brief Release the trigger's node, which is removed with its condition once its bindings are removed too
+	 */
+	~Trigger() {
+		if (!cleared()) {
+			eventLoop->release(node);
+		}
+	}
+
+	/**
+	 * @brief Create a Trigger that is true while both Triggers are true
+	 *
+	 * @param other Trigger on the same \refitem EventLoop
+	 * @return The combined Trigger
+	 */
+	Trigger operator&&(const Trigger &other) const {
+		// Make sure both triggers are on the same event loop
+		assert(eventLoop == other.eventLoop);
+
+		return {eventLoop, eventLoop->addAnd(node, other.node)};
+	}
+
+	/**
+	 * @brief Create a Trigger that is true while either Trigger is true
+	 *
+	 * @param other Trigger on the same \refitem EventLoop
+	 * @return The combined Trigger
+	 */
+	Trigger operator||(const Trigger &other) const {
+		// Make sure both triggers are on the same event loop
+		assert(eventLoop == other.eventLoop);
+
+		return {eventLoop, eventLoop->addOr(node, other.node)};
+	}
+
+	/**
+	 * @brief Create a Trigger that is true while this Trigger is false
+	 *
+	 * @return The inverted Trigger
+	 */
+	Trigger operator!() const {
+		return {eventLoop, eventLoop->addNot(node)};
+	}
+
+	/**
+	 * @brief Create a Trigger that only changes once this Trigger has held its new value for a duration
+	 *
+	 * @param duration How long a new value has to hold, measured when the \refitem EventLoop is polled, rounded to
+	 * whole microseconds
+	 * @return The debounced Trigger
+	 */
+	[[nodiscard]] Trigger debounce(const units::QTime duration) const {
+		const std::uint64_t micros = std::min<std::uint64_t>(SchedulerClock::toMicros(duration), UINT32_MAX);
+
+		return {eventLoop, eventLoop->addDebounce(node, static_cast<std::uint32_t>(micros))};
+	}
+
+	/**
+	 * @brief Create a Trigger that is only true on the poll where this Trigger changes from false to true
+	 *
+	 * @return The rising edge Trigger
+	 */
+	[[nodiscard]] Trigger risingEdge() const {
+		return {eventLoop, eventLoop->addRisingEdge(node)};
 	}
 
 	/**
@@ -38,16 +165,7 @@ public:
 	 * @return Trigger to allow for easy method chaining
 	 */
 	Trigger *onChange(Command *command) {
-		eventLoop->bind([condition = condition, previous = condition(), command]() mutable {
-			bool current = condition();
-
-			if (previous != current) {
-				command->schedule();
-			}
-
-			previous = current;
-		});
-		return this;
+		return addBinding(TriggerMode::OnChange, command);
 	}
 
 	/**
@@ -58,16 +176,7 @@ public:
 	 * @return Trigger to allow for easy method chaining
 	 */
 	Trigger *onTrue(Command *command) {
-		eventLoop->bind([condition = condition, previous = condition(), command]() mutable {
-			bool current = condition();
-
-			if (!previous && current) {
-				command->schedule();
-			}
-
-			previous = current;
-		});
-		return this;
+		return addBinding(TriggerMode::OnTrue, command);
 	}
 
 	/**
@@ -78,16 +187,7 @@ public:
 	 * @return Trigger to allow for easy method chaining
 	 */
 	Trigger *onFalse(Command *command) {
-		eventLoop->bind([condition = condition, previous = condition(), command]() mutable {
-			bool current = condition();
-
-			if (previous && !current) {
-				command->schedule();
-			}
-
-			previous = current;
-		});
-		return this;
+		return addBinding(TriggerMode::OnFalse, command);
 	}
 
 	/**
@@ -100,18 +200,7 @@ public:
 	 * @return Trigger to allow for easy method chaining
 	 */
 	Trigger *whileTrue(Command *command) {
-		eventLoop->bind([condition = condition, previous = condition(), command]() mutable {
-			bool current = condition();
-
-			if (!previous && current) {
-				command->schedule();
-			} else if (previous && !current) {
-				command->cancel();
-			}
-
-			previous = current;
-		});
-		return this;
+		return addBinding(TriggerMode::WhileTrue, command);
 	}
 
 	/**
@@ -124,18 +213,7 @@ public:
 	 * @return Trigger to allow for easy method chaining
 	 */
 	Trigger *whileFalse(Command *command) {
-		eventLoop->bind([condition = condition, previous = condition(), command]() mutable {
-			bool current = condition();
-
-			if (previous && !current) {
-				command->schedule();
-			} else if (!previous && current) {
-				command->cancel();
-			}
-
-			previous = current;
-		});
-		return this;
+		return addBinding(TriggerMode::WhileFalse, command);
 	}
 
 	/**
@@ -146,20 +224,7 @@ public:
 	 * @return Trigger to allow for easy method chaining
 	 */
 	Trigger *toggleOnTrue(Command *command) {
-		eventLoop->bind([condition = condition, previous = condition(), command]() mutable {
-			bool current = condition();
-
-			if (!previous && current) {
-				if (command->scheduled()) {
-					command->cancel();
-				} else {
-					command->schedule();
-				}
-			}
-
-			previous = current;
-		});
-		return this;
+		return addBinding(TriggerMode::ToggleOnTrue, command);
 	}
 
 	/**
@@ -170,19 +235,23 @@ public:
 	 * @return Trigger to allow for easy method chaining
 	 */
 	Trigger *toggleOnFalse(Command *command) {
-		eventLoop->bind([condition = condition, previous = condition(), command]() mutable {
-			bool current = condition();
-
-			if (previous && !current) {
-				if (command->scheduled()) {
-					command->cancel();
-				} else {
-					command->schedule();
-				}
-			}
-
-			previous = current;
-		});
-		return this;
+		return addBinding(TriggerMode::ToggleOnFalse, command);
 	}
+
+	/**
+	 * @brief Bind a command like the other binding methods, returning a handle to remove or suspend the binding with
+	 * later
+	 *
+	 * @param mode When the command is scheduled and cancelled
+	 * @param command The command to bind
+	 * @return Handle to the binding in this Trigger's \refitem EventLoop
+	 */
+	BindingHandle bind(const TriggerMode mode, Command *command) {
+		return eventLoop->bind(node, mode, command);
+	}
+
+	/**
+	 * @return The \refitem EventLoop this Trigger is polled on
+	 */
+	[[nodiscard]] EventLoop *getEventLoop() const { return eventLoop; }
 };
@@ -1,29 +1,35 @@
 #pragma once
 
+#include <cstdint>
 #include "command.h"
+#include "commandArena.h"
+#include "parallelRaceGroup.h"
+#include "schedulerClock.h"
 #include "units/units.hpp"
 
 /**
  * @brief Creates a \refitem Command with no requirements that finishes after a user-specified duration
+ *
+ * @details The duration is measured with SchedulerClock::now(), the time of the scheduler tick
  */
 class WaitCommand : public Command {
-	units::QTime startTime;
-	units::QTime duration;
+	std::uint64_t startTime = 0;
+	std::uint64_t duration;
 public:
 	/**
 	 * @brief Creates a new WaitCommand that runs for a user-specified duration
 	 *
-	 * @param duration The duration in QTime to run this \refitem Command
+	 * @param duration The duration in QTime to run this \refitem Command, rounded to whole microseconds
 	 */
 	explicit WaitCommand(const units::QTime &duration)
-		: duration(duration) {
+		: duration(SchedulerClock::toMicros(duration)) {
 	}
 
 	/**
 	 * @brief Initializes the WaitCommand and sets the start time of the WaitCommand
 	 */
 	void initialize() override {
-		startTime = pros::millis() * units::millisecond;
+		startTime = SchedulerClock::now();
 	}
 
 	/**
@@ -32,13 +38,17 @@ public:
 	 * @return Returns true if the duration has passed, false otherwise
 	 */
 	bool isFinished() override {
-		return pros::millis() * units::millisecond - startTime > duration;
+		return SchedulerClock::now() - startTime > duration;
 	}
 
 	~WaitCommand() override = default;
 };
 
 inline Command *Command::withTimeout(const units::QTime duration) {
-	return new ParallelRaceGroup({new WaitCommand(duration), this});
+	// The timeout goes on a new group so this command is unchanged wherever else it is used
+	ParallelRaceGroup *group = CommandArena::make<ParallelRaceGroup>({this});
+	group->timeout = SchedulerClock::toMicros(duration);
+
+	return group;
 }
 
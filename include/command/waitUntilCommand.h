@@ -1,6 +1,7 @@
 #pragma once
 
 #include "functionalCommand.h"
+#include "parallelRaceGroup.h"
 
 /**
  * @brief WaitUntilCommand creates a command that ends once a condition is finished (condition turns true). This command has no requirements.
@@ -12,13 +13,17 @@ public:
 	 *
 	 * @param is_finish The conditional to end with. Once it is true the command will finish
 	 */
-	explicit WaitUntilCommand(const std::function<bool()> &is_finish)
-		: FunctionalCommand([]() {}, []() {}, [](bool _) {}, is_finish, {}) {
+	explicit WaitUntilCommand(InplaceFunction<bool()> is_finish)
+		: FunctionalCommand({}, {}, {}, std::move(is_finish), {}) {
 	}
 
 	~WaitUntilCommand() override = default;
 };
 
-inline Command *Command::until(const std::function<bool()>& isFinish) {
-	return new ParallelRaceGroup({new WaitUntilCommand(isFinish), this});
+inline Command *Command::until(InplaceFunction<bool()> isFinish) {
+	// Like withTimeout, the condition goes on a new group and this command is unchanged
+	ParallelRaceGroup *group = CommandArena::make<ParallelRaceGroup>({this});
+	group->untilCondition = std::move(isFinish);
+
+	return group;
 }
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "api.h"
+
+/**
+ * @brief A fixed set of PROS tasks that run a job over a range of indices, used by the \refitem CommandScheduler to
+ * run commands in parallel
+ *
+ * @details The calling task takes part in every job, so a pool with N workers runs a job on up to N + 1 tasks. Each
+ * task starts on its own contiguous share of the indices, and tasks that finish early steal the remaining indices of
+ * the others. run() returns once every index has been processed, acting as a barrier. Running a job doesn't allocate.
+ *
+ * @warning On the V5 all user tasks share one core, so parallel jobs only help when commands block, such as waiting on
+ * a sensor. On the host the tasks are threads and jobs scale with the cores available.
+ */
+class WorkerPool {
+private:
+	// Share of the indices owned by one task, padded so tasks don't contend on each other's cursors
+	struct alignas(64) Range {
+		std::atomic<size_t> next{0};
+		size_t end = 0;
+	};
+
+	std::vector<pros::task_t> tasks;
+	std::unique_ptr<Range[]> ranges;
+	size_t rangeCount;
+
+	void (*job)(void *, size_t) = nullptr;
+	void *context = nullptr;
+
+	pros::task_t caller = nullptr;
+	std::atomic<size_t> remaining{0};
+	std::atomic<bool> stopping{false};
+
+	void process(const size_t own) {
+		for (size_t n = 0; n < rangeCount; n++) {
+			Range &range = ranges[(own + n) % rangeCount];
+
+			for (size_t i = range.next.fetch_add(1, std::memory_order_relaxed); i < range.end;
+			     i = range.next.fetch_add(1, std::memory_order_relaxed)) {
+				job(context, i);
+			}
+		}
+	}
+
+	void finish() {
+		// Once remaining reaches 0 the caller can start the next job and replace caller
+		const pros::task_t waiting = caller;
+
+		if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			pros::c::task_notify(waiting);
+		}
+	}
+
+	void work(const size_t own) {
+		while (true) {
+			pros::c::task_notify_take(true, TIMEOUT_MAX);
+
+			if (stopping.load(std::memory_order_acquire)) {
+				finish();
+				return;
+			}
+
+			process(own);
+			finish();
+		}
+	}
+
+	void wait() {
+		while (remaining.load(std::memory_order_acquire) != 0) {
+			pros::c::task_notify_take(true, TIMEOUT_MAX);
+		}
+	}
+
+public:
+	/**
+	 * @brief Start the worker tasks
+	 *
+	 * @param workers Number of tasks to start, in addition to the task calling run()
+	 * @param priority PROS priority of the worker tasks
+	 */
+	explicit WorkerPool(const size_t workers, const std::uint32_t priority = TASK_PRIORITY_DEFAULT)
+		: ranges(std::make_unique<Range[]>(workers + 1)), rangeCount(workers + 1) {
+		tasks.reserve(workers);
+
+		for (size_t i = 0; i < workers; i++) {
+			// Range 0 belongs to the caller
+			tasks.push_back(pros::Task::create([this, i]() { work(i + 1); }, priority, TASK_STACK_DEPTH_DEFAULT,
+			                                   "CommandWorker"));
+		}
+	}
+
+	WorkerPool(const WorkerPool &) = delete;
+
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	/**
+	 * @brief Call job(context, i) for every i in [0, count) across the pool, returning when all calls are done
+	 *
+	 * @param count Number of indices
+	 * @param job Function run for each index, called concurrently from different tasks
+	 * @param context Passed to each call of job
+	 */
+	void run(const size_t count, void (*job)(void *, size_t), void *context) {
+		this->job = job;
+		this->context = context;
+
+		for (size_t i = 0; i < rangeCount; i++) {
+			ranges[i].end = count * (i + 1) / rangeCount;
+			ranges[i].next.store(count * i / rangeCount, std::memory_order_relaxed);
+		}
+
+		caller = pros::c::task_get_current();
+		remaining.store(tasks.size(), std::memory_order_release);
+
+		for (const auto task : tasks) {
+			pros::c::task_notify(task);
+		}
+
+		process(0);
+
+		wait();
+	}
+
+	/**
+	 * @brief Call function(i) for every i in [0, count) across the pool, returning when all calls are done
+	 */
+	template<typename F>
+	void run(const size_t count, F &function) {
+		run(count, [](void *context, const size_t i) { (*static_cast<F *>(context))(i); }, &function);
+	}
+
+	/**
+	 * @return The number of worker tasks, not counting the caller
+	 */
+	[[nodiscard]] size_t getWorkers() const { return tasks.size(); }
+
+	/**
+	 * @brief Stop the worker tasks, waiting for them to leave the pool
+	 */
+	~WorkerPool() {
+		caller = pros::c::task_get_current();
+		remaining.store(tasks.size(), std::memory_order_release);
+		stopping.store(true, std::memory_order_release);
+
+		for (const auto task : tasks) {
+			pros::c::task_notify(task);
+		}
+
+		wait();
+	}
+};
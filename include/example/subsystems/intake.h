@@ -59,14 +59,14 @@ public:
 	 * @return Command pointer to a RunCommand that moves the intake
 	 */
 	RunCommand* pctCommand(const double pct) {
-		// Create a new RunCommand
+		// Create a new RunCommand, in the current CommandArena if there is one
 		// The lambda body is called at every update, in this case setting the intake percentage
-		return new RunCommand(
+		return CommandArena::make<RunCommand>(
 			[this, pct] () // Capture "this" and the percentage request
 			{
 				this->setPct(pct); // Set the percentage of the intake to the request
 			},
-			{this} // Add "this", the pointer to this subsystem that is currently running.
+			std::initializer_list<Subsystem*>{this} // Add "this", the pointer to this subsystem that is currently running.
 			       // It is important to ensure that all subsystems that are being utilized in a command are properly
 			       // Freed to allow that command to run.
 			);
@@ -6,35 +6,22 @@ CommandController primary(pros::E_CONTROLLER_MASTER);
 
 Intake *intake;
 
-/**
- * @brief This function runs the update scheduler at each frame with a consistent schedule
- *
- * @warning This function or alternative similar to it must be running to ensure the \refitem CommandScheduler is run
- */
-[[noreturn]] void update_loop() {
-	// Loop forever
-	while (true) {
-		// Store the start time
-		auto start_time = pros::millis();
-
-		// Run the command scheduler
-		// This might be an expensive(Time wise) computation
-		CommandScheduler::run();
-
-		// Use delay until if this computation ends up being expensive, keeping loop time in check
-		pros::c::task_delay_until(&start_time, 10);
-	}
-}
+// Runs the command scheduler every 10ms and records overruns and jitter, see getOverruns() and getWorstTicks(). Read
+// the statistics from the scheduler task, such as in a subsystem periodic
+SchedulerRunner schedulerRunner(10_ms);
 
-void initialize() {
-	// Start the command scheduler task
-	pros::Task commandSchedulerTask(update_loop);
+// Owns the commands of the controller bindings and the bindings themselves, resetting it removes both
+CommandArena bindingArena;
 
+void initialize() {
 	// Create a new intake object and store it in the global intake
 	intake = new Intake(pros::Motor(1));
 
 	CommandScheduler::registerSubsystem(intake, intake->pctCommand(0.0));
 
+	// Create the binding commands in bindingArena instead of separate heap allocations
+	CommandArena::Scope scope(bindingArena);
+
 	// Set pctCommand to run while R1 is true
 	primary.getTrigger(DIGITAL_R1)->whileTrue(intake->pctCommand(-1.0));
 
@@ -47,6 +34,10 @@ void initialize() {
 														->andThen(intake->pctCommand(1.0)
 															->withTimeout(300_ms))
 														->repeatedly());
+
+	// Start the command scheduler task once everything is bound, schedules from other tasks such as autonomous() are
+	// then handed to it through its request queue
+	schedulerRunner.start();
 }
 
 void disabled() {}